@@ -3,56 +3,117 @@
 #include "Engine/TextureRenderTarget.h"
 #include "SceneViewExtensionContext.h"
 #include "Algo/AllOf.h"
+#include "Async/ParallelFor.h"
+#include "Runtime/Renderer/Private/ScenePrivate.h"
 
 
+static TAutoConsoleVariable<int32> CVarEGPPerViewDataBudgetMB(
+	TEXT("r.EGP.PerViewData.BudgetMB"),
+	0,
+	TEXT("How much GPU memory each EGP render pass may keep for its per-view data (sim textures, etc), ")
+	TEXT("unless the pass sets its own budget. When over budget, the least important views are cleaned up.\n")
+	TEXT("0 means no limit."),
+	ECVF_RenderThreadSafe | ECVF_Scalability
+);
+uint64 EGP::GetDefaultPerViewDataBudgetBytes()
+{
+	return static_cast<uint64>(FMath::Max(0, CVarEGPPerViewDataBudgetMB.GetValueOnRenderThread())) * 1024 * 1024;
+}
+
+
+const EGP::FViewFilterSnapshot& U_EGP_ViewFilter::GetFilters() const
+{
+	if (IsInGameThread())
+		return filters_GT;
+
+	check(IsInRenderingThread());
+	//Nothing is published until the first frame, so fall back to an empty filter.
+	static const EGP::FViewFilterSnapshot noFilters;
+	const auto* snapshot = publishedFilters.load(std::memory_order_acquire);
+	return (snapshot == nullptr) ? noFilters : *snapshot;
+}
+void U_EGP_ViewFilter::PublishChanges_GameThread()
+{
+	check(IsInGameThread());
+	if (!filtersChanged_GT)
+		return;
+	filtersChanged_GT = false;
+
+	filters_GT.Version += 1;
+	const auto* oldSnapshot = publishedFilters.exchange(new EGP::FViewFilterSnapshot(filters_GT),
+														std::memory_order_acq_rel);
+
+	//The render thread may be in the middle of reading the old snapshot.
+	//Every render command queued from now on will see the new one,
+	//    so the old one can be deleted once the render thread reaches this command.
+	if (oldSnapshot != nullptr)
+		ENQUEUE_RENDER_COMMAND(RetireViewFilterSnapshot)([oldSnapshot](FRHICommandListImmediate&)
+		{
+			delete oldSnapshot;
+		});
+}
+void U_EGP_ViewFilter::BeginDestroy()
+{
+	//Retire the last snapshot the same way as in PublishChanges_GameThread().
+	if (const auto* snapshot = publishedFilters.exchange(nullptr))
+		ENQUEUE_RENDER_COMMAND(RetireViewFilterSnapshot)([snapshot](FRHICommandListImmediate&)
+		{
+			delete snapshot;
+		});
+
+	Super::BeginDestroy();
+}
+
 bool U_EGP_ViewFilter::ShouldRenderFor(const FViewport* viewport) const
 {
-	bool rThread = IsInRenderingThread(),
-		 gThread = IsInGameThread();
-	check(rThread || gThread);
-	
-	return !ExcludeAll &&
-		     ((rThread && byViewport_RT.IsAllowed(viewport)) ||
-		      (gThread && byViewport_GT.IsAllowed(viewport)));
+	return !ExcludeAll && GetFilters().ByViewport.IsAllowed(viewport);
 }
 bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneInterface* scene) const
 {
-	bool rThread = IsInRenderingThread(),
-		 gThread = IsInGameThread();
-	check(rThread || gThread);
-	
-	return !ExcludeAll &&
-		     ((rThread && byScene_RT.IsAllowed(scene)) ||
-		      (gThread && byScene_GT.IsAllowed(scene)));
+	return !ExcludeAll && GetFilters().ByScene.IsAllowed(scene);
 }
 bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneViewExtensionContext& sveContext) const
 {
-	return ShouldRenderFor(sveContext.Scene) &&
-		   ShouldRenderFor(sveContext.Viewport);
+	if (ExcludeAll)
+		return false;
+	const auto& filters = GetFilters();
+	return filters.ByScene.IsAllowed(sveContext.Scene) &&
+		   filters.ByViewport.IsAllowed(sveContext.Viewport);
 }
 bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneViewFamily& viewFamily) const
 {
-	bool rThread = IsInRenderingThread(),
-		 gThread = IsInGameThread();
-	check(rThread || gThread);
-	
-	return !ExcludeAll &&
-		     ((rThread && byScene_RT.IsAllowed(viewFamily.Scene)) ||
-		      (gThread && byScene_GT.IsAllowed(viewFamily.Scene))) &&
-		     ((rThread && byRenderTarget_RT.IsAllowed(viewFamily.RenderTarget)) ||
-		      (gThread && byRenderTarget_GT.IsAllowed(viewFamily.RenderTarget)));
+	return !ExcludeAll && ShouldRenderFor(GetFilters(), viewFamily);
+}
+bool U_EGP_ViewFilter::ShouldRenderFor(const EGP::FViewFilterSnapshot& filters, const FSceneViewFamily& viewFamily) const
+{
+	//On the render thread, re-use the decision made earlier this frame for the same scene and render target.
+	const bool rThread = !IsInGameThread();
+	if (rThread)
+	{
+		if (familyDecisions_RT.Num() > 0 && familyDecisions_RT[0].FrameNumber != viewFamily.FrameNumber)
+			familyDecisions_RT.Reset();
+		for (const auto& decision : familyDecisions_RT)
+			if (decision.Scene == viewFamily.Scene && decision.RenderTarget == viewFamily.RenderTarget &&
+				decision.FilterVersion == filters.Version)
+				return decision.Result;
+	}
+
+	const bool result = filters.ByScene.IsAllowed(viewFamily.Scene) &&
+						filters.ByRenderTarget.IsAllowed(viewFamily.RenderTarget);
+
+	if (rThread)
+		familyDecisions_RT.Add({ viewFamily.Scene, viewFamily.RenderTarget,
+								 viewFamily.FrameNumber, filters.Version, result });
+	return result;
 }
 bool U_EGP_ViewFilter::ShouldRenderFor(const FSceneView& view) const
 {
-	bool rThread = IsInRenderingThread(),
-		 gThread = IsInGameThread();
-	check(rThread || gThread);
-	
-	return ShouldRenderFor(*view.Family) &&
-		   ((rThread && byPlayerIndex_RT.IsAllowed(view.PlayerIndex)) ||
-		   	(gThread && byPlayerIndex_GT.IsAllowed(view.PlayerIndex))) &&
-		   ((rThread && byViewActor_RT.IsAllowed(view.ViewActor)) ||
-		   	(gThread && byViewActor_GT.IsAllowed(view.ViewActor)));
+	if (ExcludeAll)
+		return false;
+	const auto& filters = GetFilters();
+	return ShouldRenderFor(filters, *view.Family) &&
+		   filters.ByPlayerIndex.IsAllowed(view.PlayerIndex) &&
+		   filters.ByViewActor.IsAllowed(view.ViewActor);
 }
 
 void U_EGP_ViewFilter::FilterByRenderTarget(UTextureRenderTarget* rt, bool isWhitelist)
@@ -62,7 +123,7 @@ void U_EGP_ViewFilter::FilterByRenderTarget(UTextureRenderTarget* rt, bool isWhi
 	if (rt == nullptr)
 	{
 		const FRenderTarget* nullRT = nullptr;
-		UpdateFilterList(byRenderTarget_GT, byRenderTarget_RT, nullRT, true, isWhitelist);
+		UpdateFilterList(&EGP::FViewFilterSnapshot::ByRenderTarget, nullRT, true, isWhitelist);
 	}
 	else
 	{
@@ -79,7 +140,7 @@ void U_EGP_ViewFilter::RemoveByRenderTarget(UTextureRenderTarget* rt)
 	if (rt == nullptr)
 	{
 		const FRenderTarget* nullRT = nullptr;
-		UpdateFilterList(byRenderTarget_GT, byRenderTarget_RT, nullRT, true, false);
+		UpdateFilterList(&EGP::FViewFilterSnapshot::ByRenderTarget, nullRT, true, false);
 	}
 	else
 	{
@@ -92,9 +153,16 @@ void U_EGP_ViewFilter::RemoveByRenderTarget(UTextureRenderTarget* rt)
 
 
 U_EGP_RenderPassComponent::U_EGP_RenderPassComponent()
-	: renderThreadProxy(MakeShared<EGP::CustomRenderPasses::ProxyData_t>())
 {
-	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bCanEverTick = !UpdateFromSubsystem;
+}
+void U_EGP_RenderPassComponent::OnRegister()
+{
+	//'UpdateFromSubsystem' may have been changed on this instance since the constructor ran.
+	//The tick function isn't registered until after this, so it's not too late to decide.
+	PrimaryComponentTick.bCanEverTick = !UpdateFromSubsystem;
+
+	Super::OnRegister();
 }
 void U_EGP_RenderPassComponent::BeginPlay()
 {
@@ -104,7 +172,11 @@ void U_EGP_RenderPassComponent::BeginPlay()
 	auto* subsystem = (IsValid(world)) ? world->GetSubsystem<U_EGP_RenderPassSubsystem>() : nullptr;
 	auto* pass = IsValid(subsystem) ? subsystem->GetPass(GetPassType(), true) : nullptr;
 	if (IsValid(pass))
+	{
 		pass->RegisterPassComponent(this);
+		registeredPass = pass;
+		isProxyDirty = true;
+	}
 	else
 		UE_LOG(LogEGP, Error,
 			   TEXT("%s component created but there's no world/subsystem for custom render passes! No custom rendering can happen"),
@@ -115,31 +187,73 @@ void U_EGP_RenderPassComponent::EndPlay(const EEndPlayReason::Type reason)
 	auto* world = GetWorld();
 	auto* subsystem = (IsValid(world)) ? world->GetSubsystem<U_EGP_RenderPassSubsystem>() : nullptr;
 	auto* pass = IsValid(subsystem) ? subsystem->GetPass(GetPassType(), true) : nullptr;
+	//Queue the proxy's removal before unregistering, which releases the proxy's handle.
 	if (IsValid(pass))
+	{
+		pass->QueueProxyRemoval_GameThread(this);
 		pass->UnregisterPassComponent(this);
-	
-	DestructProxyData_GameThread();
+	}
+	registeredPass = nullptr;
 	
 	Super::EndPlay(reason);
 }
 void U_EGP_RenderPassComponent::TickComponent(float deltaSeconds, ELevelTick, FActorComponentTickFunction*)
 {
+	if (!IsValid(registeredPass))
+		return;
+
 	//Update the render-thread references.
 	//TODO: Double-check that this actually works as intended (change proxy data during play and see that it updates).
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*FString::Printf(TEXT("EGP.UpdateCustomRenderProxy %s"), *GetName()));
-		EGP::CustomRenderPasses::ProxyData_t newProxy;
-		ConstructProxyData_GameThread(newProxy);
-		
-		auto renderThreadSharedPtr = renderThreadProxy;
-		auto* targetPtr = &renderThreadTarget;
-		auto* newTarget = Cast<UPrimitiveComponent>(GetAttachParent());
-		ENQUEUE_RENDER_COMMAND(CopyCustomPassProxy)([renderThreadSharedPtr, targetPtr, newProxy, newTarget](FRHICommandListImmediate&)
-		{
-			*renderThreadSharedPtr = newProxy;
-			*targetPtr = newTarget;
-		});
+		if (BuildProxy_GameThread())
+			SendBuiltProxy_GameThread();
+	}
+}
+bool U_EGP_RenderPassComponent::BuildProxy_GameThread()
+{
+	const int32 proxySize = GetProxySize();
+	newTarget_GameThread = Cast<UPrimitiveComponent>(GetAttachParent());
+
+	//Zero the memory first so that padding is deterministic, for change-detection.
+	newProxy_GameThread.SetNumUninitialized(proxySize, EAllowShrinking::No);
+	FMemory::Memzero(newProxy_GameThread.GetData(), proxySize);
+	ConstructProxyData_GameThread(newProxy_GameThread.GetData());
+
+	//Most components never change, so don't send anything if this tick's data matches the last one.
+	//Moving targets do need to be re-sent, so the render thread can keep its spatial index up to date.
+	//So do targets that got a new scene proxy, so the render thread knows to look them up again.
+	const bool isUnchanged = !isProxyDirty &&
+							 newTarget_GameThread == lastSentTarget_GameThread.Get() &&
+							 (newTarget_GameThread == nullptr ||
+							  (newTarget_GameThread->SceneProxy == lastSentTargetProxy_GameThread &&
+							   newTarget_GameThread->Bounds.Origin == lastSentTargetBounds_GameThread.Origin &&
+							   newTarget_GameThread->Bounds.BoxExtent == lastSentTargetBounds_GameThread.BoxExtent)) &&
+							 proxySize == lastSentProxy_GameThread.Num() &&
+							 FMemory::Memcmp(newProxy_GameThread.GetData(), lastSentProxy_GameThread.GetData(), proxySize) == 0;
+	if (isUnchanged)
+	{
+		DestructProxyData_GameThread(newProxy_GameThread.GetData());
+		return false;
 	}
+	return true;
+}
+void U_EGP_RenderPassComponent::SendBuiltProxy_GameThread()
+{
+	lastSentProxy_GameThread = newProxy_GameThread;
+	lastSentTarget_GameThread = newTarget_GameThread;
+	lastSentTargetBounds_GameThread = (newTarget_GameThread == nullptr) ?
+										  FBoxSphereBounds{ ForceInit } :
+										  newTarget_GameThread->Bounds;
+	lastSentTargetProxy_GameThread = (newTarget_GameThread == nullptr) ?
+										 nullptr :
+										 newTarget_GameThread->SceneProxy;
+	isProxyDirty = false;
+
+	//The pass sends all of this frame's changes to the render thread at once.
+	//It takes ownership of the new proxy.
+	registeredPass->QueueProxyUpdate_GameThread(this, newProxy_GameThread.GetData(), newProxy_GameThread.Num(),
+												newTarget_GameThread, lastSentTargetBounds_GameThread);
 }
 
 U_EGP_RenderPass::U_EGP_RenderPass()
@@ -149,62 +263,159 @@ U_EGP_RenderPass::U_EGP_RenderPass()
 }
 inline void U_EGP_RenderPass::Tick_GameThread(UWorld& thisWorld, float deltaSeconds)
 {
-	//Collect the components to use in the pass this frame and send it to the render thread.
-	//Try to avoid heap usage, but also avoid coming up with a complex memory-pooling solution for this array,
-	//    by assuming there are at most N components.
-	constexpr uint32 StackCount = 256;
-	TArray<U_EGP_RenderPassComponent*, TInlineAllocator<StackCount>> components;
-	for (const auto& c : Components_GameThread)
-		if (IsValid(c))
-			components.Add(c);
-	if (!warnedAboutArrayHeapUsage && components.Num() > StackCount)
-	{
-		UE_LOG(LogEGP, Warning,
-			   TEXT("Custom render pass '%s' can only hold %i components "
-					  "before some heap usage happens every frame. We are now at %i components!"),
-			   *GetName(), StackCount, components.Num());
-		warnedAboutArrayHeapUsage = true;
-	}
+	//Hand this frame's proxy changes (if any) to the render thread, and schedule a render-thread tick.
+	//This is the only render command the pass's components need per frame.
+	auto* mailbox = currentMailbox_GameThread;
+	currentMailbox_GameThread = nullptr;
 
-	//Submit the proxy data and schedule a render-thread tick.
 	auto* _this = this;
 	const auto* scene = thisWorld.Scene;
-	ENQUEUE_RENDER_COMMAND(UpdateCustomRenderPassProxies)([_this, scene, deltaSeconds, components = MoveTemp(components)](FRHICommandListImmediate&)
+	ENQUEUE_RENDER_COMMAND(UpdateCustomRenderPassProxies)([_this, scene, deltaSeconds, mailbox](FRHICommandListImmediate&)
 	{
-		_this->ComponentProxies_RenderThread.Reset();
-		for (const auto& c : components)
+		if (mailbox != nullptr)
 		{
-			const auto& proxy = c->GetProxy_RenderThread();
-			if (!_this->warnedAboutProxyHeapUsage && proxy.Num() > EGP::CustomRenderPasses::MaxInlineProxyByteSize)
-			{
-				UE_LOG(LogEGP, Warning,
-					   TEXT("Render-thread proxy for custom render pass '%s' exceeds %i bytes (%i), "
-							   "meaning it is allocated on the heap instead of the stack, "
-							   "several times per frame per component! "
-							   "Consider replacing the struct with a pooled memory pointer to avoid a performance hit."),
-					   *_this->GetName(), EGP::CustomRenderPasses::MaxInlineProxyByteSize, proxy.Num());
-				_this->warnedAboutProxyHeapUsage = true;
-			}
-			
-			_this->ComponentProxies_RenderThread.Add(c, proxy);
+			_this->ApplyMailbox_RenderThread(*mailbox);
+			_this->recycledMailboxes.Enqueue(mailbox);
 		}
 
 		_this->Tick_RenderThread(*scene, deltaSeconds);
 	});
 }
+void U_EGP_RenderPass::UpdateBatchedComponents_GameThread()
+{
+	check(IsInGameThread());
+	TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*FString::Printf(TEXT("EGP.UpdateBatchedProxies %s"), *GetName()));
+
+	//Build every proxy in parallel, then queue the changed ones in order (the mailbox isn't thread-safe).
+	ParallelFor(TEXT("EGP.BuildBatchedProxies"), parallelBatchedComponents_GameThread.Num(), 64,
+				[&](int32 i)
+	{
+		auto* component = parallelBatchedComponents_GameThread[i];
+		component->hasBuiltProxy = component->BuildProxy_GameThread();
+	});
+	for (auto* component : parallelBatchedComponents_GameThread)
+		if (component->hasBuiltProxy)
+			component->SendBuiltProxy_GameThread();
+
+	for (auto* component : batchedComponents_GameThread)
+		if (component->BuildProxy_GameThread())
+			component->SendBuiltProxy_GameThread();
+}
 inline void U_EGP_RenderPass::Tick_RenderThread(const FSceneInterface& thisScene, float gameThreadDeltaSeconds)
 {
 	
 }
+EGP::CustomRenderPasses::FProxyMailbox& U_EGP_RenderPass::GetMailbox_GameThread()
+{
+	check(IsInGameThread());
+	if (currentMailbox_GameThread != nullptr)
+		return *currentMailbox_GameThread;
+
+	//Re-use a mailbox the render thread is done with, or make a new one if they're all in flight.
+	EGP::CustomRenderPasses::FProxyMailbox* mailbox = nullptr;
+	if (recycledMailboxes.Dequeue(mailbox))
+	{
+		mailbox->Reset();
+	}
+	else
+	{
+		mailbox = allMailboxes.Emplace_GetRef(MakeUnique<EGP::CustomRenderPasses::FProxyMailbox>()).Get();
+	}
+
+	currentMailbox_GameThread = mailbox;
+	return *mailbox;
+}
+void U_EGP_RenderPass::QueueProxyUpdate_GameThread(const U_EGP_RenderPassComponent* component,
+												   void* proxy, int32 proxySize,
+												   UPrimitiveComponent* target, const FBoxSphereBounds& targetBounds)
+{
+	auto& mailbox = GetMailbox_GameThread();
+	auto& entry = mailbox.Entries.Emplace_GetRef();
+	entry.Handle = component->proxyHandle;
+	//The render thread finds the primitive by its ID, so it never has to touch the component.
+	if (target != nullptr)
+		entry.TargetID = target->GetPrimitiveSceneId();
+	entry.TargetBounds = targetBounds;
+
+	//Relocate the proxy into the mailbox, keeping it aligned.
+	//Like any UE container element, proxies are assumed to be bitwise-relocatable.
+	entry.ByteOffset = Align(mailbox.Bytes.Num(), EGP::CustomRenderPasses::MaxProxyAlignment);
+	entry.ByteSize = proxySize;
+	mailbox.Bytes.SetNumUninitialized(entry.ByteOffset + proxySize, EAllowShrinking::No);
+	FMemory::Memcpy(mailbox.Bytes.GetData() + entry.ByteOffset, proxy, proxySize);
+}
+void U_EGP_RenderPass::QueueProxyRemoval_GameThread(const U_EGP_RenderPassComponent* component)
+{
+	auto& entry = GetMailbox_GameThread().Entries.Emplace_GetRef();
+	entry.Handle = component->proxyHandle;
+	entry.IsRemoval = true;
+}
+void U_EGP_RenderPass::ApplyMailbox_RenderThread(EGP::CustomRenderPasses::FProxyMailbox& mailbox)
+{
+	check(IsInRenderingThread());
+
+	//Passes whose scene-view extension doesn't use components have nowhere to put proxies.
+	if (!ComponentProxies_RenderThread.IsValid())
+		return;
+
+	for (const auto& entry : mailbox.Entries)
+	{
+		if (entry.Handle == INDEX_NONE)
+			continue;
+
+		if (entry.IsRemoval)
+			ComponentProxies_RenderThread->Remove(entry.Handle);
+		else
+			ComponentProxies_RenderThread->Update(entry.Handle, entry.TargetID, entry.TargetBounds,
+												  mailbox.Bytes.GetData() + entry.ByteOffset, entry.ByteSize);
+	}
+}
+
 void U_EGP_RenderPass::RegisterPassComponent(U_EGP_RenderPassComponent* component)
 {
 	check(IsInGameThread());
-	Components_GameThread.Add(component);
+	bool wasAlreadyRegistered;
+	Components_GameThread.Add(component, &wasAlreadyRegistered);
+	if (wasAlreadyRegistered)
+		return;
+
+	//Give the component a stable slot in the render-thread storage.
+	component->proxyHandle = (freeProxyHandles_GameThread.Num() > 0) ?
+								 freeProxyHandles_GameThread.Pop(EAllowShrinking::No) :
+								 nextProxyHandle_GameThread++;
+
+	if (component->UpdateFromSubsystem)
+	{
+		auto& batch = component->IsProxyConstructionThreadSafe() ?
+						  parallelBatchedComponents_GameThread :
+						  batchedComponents_GameThread;
+		component->batchedUpdateIndex = batch.Add(component);
+	}
 }
 void U_EGP_RenderPass::UnregisterPassComponent(U_EGP_RenderPassComponent* component)
 {
 	check(IsInGameThread());
-	Components_GameThread.Remove(component);
+	if (Components_GameThread.Remove(component) == 0)
+		return;
+
+	//The handle can be re-used right away;
+	//    the render thread always applies this component's removal before anything queued after it.
+	freeProxyHandles_GameThread.Add(component->proxyHandle);
+	component->proxyHandle = INDEX_NONE;
+
+	if (component->batchedUpdateIndex != INDEX_NONE)
+	{
+		auto& batch = component->IsProxyConstructionThreadSafe() ?
+						  parallelBatchedComponents_GameThread :
+						  batchedComponents_GameThread;
+		const int32 idx = component->batchedUpdateIndex;
+		check(batch[idx] == component);
+
+		batch.RemoveAtSwap(idx, EAllowShrinking::No);
+		if (batch.IsValidIndex(idx))
+			batch[idx]->batchedUpdateIndex = idx;
+		component->batchedUpdateIndex = INDEX_NONE;
+	}
 }
 
 
@@ -221,7 +432,11 @@ void U_EGP_RenderPassSubsystem::Tick(float deltaSeconds)
 	for (const auto& [type, pass] : passes)
 		passBuffer.Add(pass);
 	for (auto pass : passBuffer)
+	{
+		pass->ViewFilter->PublishChanges_GameThread();
+		pass->UpdateBatchedComponents_GameThread();
 		pass->Tick_GameThread(*world, deltaSeconds);
+	}
 	passBuffer.Empty();
 }
 void U_EGP_RenderPassSubsystem::BeginDestroy()
@@ -314,4 +529,129 @@ bool U_EGP_RenderPassSubsystem::DestroyPass_Impl_GameThread(TSubclassOf<U_EGP_Re
 	fence->BeginFence();
 	
 	return true;
-}
\ No newline at end of file
+}
+
+
+void EGP::CustomRenderPasses::FComponentProxyStorage::Update(int32 handle, FPrimitiveComponentId targetID,
+															  const FBoxSphereBounds& targetBounds,
+															  void* movedProxy, int32 movedProxySize)
+{
+	checkf(movedProxySize == GetProxySize(),
+		   TEXT("Component proxy is %i bytes, but the pass's 'PrimitiveProxyType' is %i bytes. ")
+			   TEXT("The component's 'GetProxySize()' must match its pass's proxy type"),
+		   movedProxySize, GetProxySize());
+
+	while (denseIndexByHandle.Num() <= handle)
+	{
+		denseIndexByHandle.Add(INDEX_NONE);
+		octreeIDByHandle.Emplace();
+	}
+
+	int32& denseIdx = denseIndexByHandle[handle];
+	if (denseIdx == INDEX_NONE)
+	{
+		denseIdx = TargetIDs.Add(targetID);
+		targetCaches.Emplace();
+		handleByDenseIndex.Add(handle);
+		AddProxy(movedProxy);
+	}
+	else
+	{
+		if (TargetIDs[denseIdx] != targetID)
+		{
+			TargetIDs[denseIdx] = targetID;
+			targetCaches[denseIdx] = { };
+		}
+		//The game thread re-sends whenever the target gets a new scene proxy, so look for it again if it's missing.
+		else if (targetCaches[denseIdx].SceneIndex == INDEX_NONE)
+		{
+			targetCaches[denseIdx].SearchesLeft = FTargetCache::NumSearchFrames;
+		}
+		AssignProxy(denseIdx, movedProxy);
+	}
+
+	//Re-insert the bounds into the octree.
+	//Components without a target can't be drawn, so they're left out.
+	auto& octreeID = octreeIDByHandle[handle];
+	if (octreeID.IsValidId())
+	{
+		boundsOctree.RemoveElement(octreeID);
+		octreeID = { };
+	}
+	if (targetID.IsValid())
+		boundsOctree.AddElement(FOctreeElement{ handle, FBoxCenterAndExtent{ targetBounds }, this });
+}
+void EGP::CustomRenderPasses::FComponentProxyStorage::Remove(int32 handle)
+{
+	if (!denseIndexByHandle.IsValidIndex(handle) || denseIndexByHandle[handle] == INDEX_NONE)
+		return;
+	const int32 denseIdx = denseIndexByHandle[handle];
+
+	auto& octreeID = octreeIDByHandle[handle];
+	if (octreeID.IsValidId())
+	{
+		boundsOctree.RemoveElement(octreeID);
+		octreeID = { };
+	}
+
+	//Move the last element into the hole.
+	const int32 lastHandle = handleByDenseIndex.Last();
+	TargetIDs.RemoveAtSwap(denseIdx, EAllowShrinking::No);
+	targetCaches.RemoveAtSwap(denseIdx, EAllowShrinking::No);
+	handleByDenseIndex.RemoveAtSwap(denseIdx, EAllowShrinking::No);
+	RemoveProxyAtSwap(denseIdx);
+	if (lastHandle != handle)
+		denseIndexByHandle[lastHandle] = denseIdx;
+	denseIndexByHandle[handle] = INDEX_NONE;
+}
+const FPrimitiveSceneProxy* EGP::CustomRenderPasses::FComponentProxyStorage::ResolvePrimitive_RenderThread(
+	const FScene& scene, int32 denseIdx)
+{
+	check(IsInRenderingThread());
+	const auto targetID = TargetIDs[denseIdx];
+	if (!targetID.IsValid())
+		return nullptr;
+
+	//The fast path: the cached primitive is still at the same persistent index.
+	auto& cache = targetCaches[denseIdx];
+	if (cache.SceneIndex != INDEX_NONE)
+	{
+		const auto* sceneInfo = scene.GetPrimitiveSceneInfo(FPersistentPrimitiveIndex{ cache.SceneIndex });
+		if (sceneInfo != nullptr && sceneInfo->PrimitiveComponentId == targetID)
+			return sceneInfo->Proxy;
+
+		//It was removed or moved to another index.
+		cache.SceneIndex = INDEX_NONE;
+		cache.SearchesLeft = FTargetCache::NumSearchFrames;
+	}
+
+	//Missing targets are only searched for (at most once per frame) until their search runs out;
+	//    after that, nothing happens until the target changes again.
+	const uint64 frame = GFrameCounterRenderThread;
+	if (cache.SearchesLeft == 0 || cache.MissFrame == frame)
+		return nullptr;
+
+	//The slow path: look up the primitive by ID.
+	if (sceneIndexByIDFrame != frame)
+	{
+		sceneIndexByID.Reset();
+		sceneIndexByID.Reserve(scene.Primitives.Num());
+		for (const auto* sceneInfo : scene.Primitives)
+			sceneIndexByID.Add(sceneInfo->PrimitiveComponentId, sceneInfo->GetPersistentIndex().Index);
+		sceneIndexByIDFrame = frame;
+	}
+
+	const int32* found = sceneIndexByID.Find(targetID);
+	const auto* sceneInfo = (found == nullptr) ?
+								nullptr :
+								scene.GetPrimitiveSceneInfo(FPersistentPrimitiveIndex{ *found });
+	if (sceneInfo == nullptr)
+	{
+		cache.MissFrame = frame;
+		cache.SearchesLeft -= 1;
+		return nullptr;
+	}
+
+	cache = { *found };
+	return sceneInfo->Proxy;
+}
@@ -0,0 +1,143 @@
+#include "EGP_DepthPyramid.h"
+
+#include "DataDrivenShaderPlatformInfo.h"
+#include "RenderGraphBlackboard.h"
+#include "RenderGraphUtils.h"
+#include "Runtime/Renderer/Private/SceneRendering.h"
+
+
+class FEGPDepthPyramidCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPDepthPyramidCS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPDepthPyramidCS, FGlobalShader);
+
+	//Each group reduces an 8x8 tile of mip 0, which is a single texel of mip 3.
+	static constexpr int GroupSize = 8;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, SceneDepthTex)
+		SHADER_PARAMETER(FUintVector2, SrcPixelMin)
+		SHADER_PARAMETER(FUintVector2, SrcPixelMax)
+		SHADER_PARAMETER(FUintVector2, Mip0Size)
+		SHADER_PARAMETER(uint32, NumMips)
+		SHADER_PARAMETER(uint32, NumGroups)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV_ARRAY(RWTexture2D<float2>, MinMaxOutput, [EGP::FDepthPyramid::MaxMips])
+		SHADER_PARAMETER_RDG_TEXTURE_UAV_ARRAY(RWTexture2D<float>, CheckerboardOutput, [EGP::FDepthPyramid::MaxMips])
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<uint>, GroupCounter)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& params)
+	{
+		return IsFeatureLevelSupported(params.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FEGPDepthPyramidCS, "/EGP/DepthPyramid/depth_pyramid_cs.usf", "MainCS", SF_Compute);
+
+
+FIntPoint EGP::FDepthPyramid::GetMipSize(int mip) const
+{
+	//Round up, so that the edge texels still cover the last row/column of the view.
+	return FIntPoint{ FMath::Max(1, (Mip0Size.X + (1 << mip) - 1) >> mip),
+					  FMath::Max(1, (Mip0Size.Y + (1 << mip) - 1) >> mip) };
+}
+int EGP::FDepthPyramid::GetMipForResolution(const FIntPoint& resolution) const
+{
+	int mip = 0;
+	while (mip + 1 < NumMips)
+	{
+		auto nextSize = GetMipSize(mip + 1);
+		if (nextSize.X < resolution.X || nextSize.Y < resolution.Y)
+			break;
+		mip += 1;
+	}
+	return mip;
+}
+
+EGP::FDepthPyramid EGP::AddDepthPyramidPass(FRDGBuilder& builder, const FViewInfo& view,
+											 FRDGTextureRef sceneDepth,
+											 bool asyncCompute, int maxMips)
+{
+	FDepthPyramid pyramid;
+	pyramid.Mip0Size = FIntPoint{ FMath::Max(1, (view.ViewRect.Width() + 1) / 2),
+								  FMath::Max(1, (view.ViewRect.Height() + 1) / 2) };
+	pyramid.NumMips = FMath::Clamp(
+		1 + static_cast<int>(FMath::CeilLogTwo(static_cast<uint32>(pyramid.Mip0Size.GetMax()))),
+		1, FMath::Min(maxMips, static_cast<int>(FDepthPyramid::MaxMips))
+	);
+
+	pyramid.MinMax = builder.CreateTexture(
+		FRDGTextureDesc::Create2D(pyramid.Mip0Size, PF_G32R32F, FClearValueBinding::None,
+								  TexCreate_ShaderResource | TexCreate_UAV,
+								  static_cast<uint8>(pyramid.NumMips)),
+		TEXT("EGP_DepthPyramid_MinMax")
+	);
+	pyramid.Checkerboard = builder.CreateTexture(
+		FRDGTextureDesc::Create2D(pyramid.Mip0Size, PF_R32_FLOAT, FClearValueBinding::None,
+								  TexCreate_ShaderResource | TexCreate_UAV,
+								  static_cast<uint8>(pyramid.NumMips)),
+		TEXT("EGP_DepthPyramid_Checkerboard")
+	);
+
+	const auto passFlags = (asyncCompute && GSupportsEfficientAsyncCompute) ?
+							   ERDGPassFlags::AsyncCompute :
+							   ERDGPassFlags::Compute;
+
+	//The last group to finish its tile reduces the rest of the chain,
+	//    so the groups need a counter to find out who was last.
+	auto groupCounter = builder.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(sizeof(uint32), 1),
+											 TEXT("EGP_DepthPyramid_GroupCounter"));
+	auto groupCounterUAV = builder.CreateUAV(groupCounter);
+	AddClearUAVPass(builder, passFlags, groupCounterUAV, 0);
+
+	const auto groupCount = FComputeShaderUtils::GetGroupCount(pyramid.Mip0Size, FEGPDepthPyramidCS::GroupSize);
+
+	auto* params = builder.AllocParameters<FEGPDepthPyramidCS::FParameters>();
+	params->SceneDepthTex = sceneDepth;
+	params->SrcPixelMin = FUintVector2(view.ViewRect.Min.X, view.ViewRect.Min.Y);
+	params->SrcPixelMax = FUintVector2(view.ViewRect.Max.X - 1, view.ViewRect.Max.Y - 1);
+	params->Mip0Size = FUintVector2(pyramid.Mip0Size.X, pyramid.Mip0Size.Y);
+	params->NumMips = pyramid.NumMips;
+	params->NumGroups = groupCount.X * groupCount.Y;
+	//Mips past the end of the chain are left unbound; the shader never touches them.
+	for (int mip = 0; mip < pyramid.NumMips; ++mip)
+	{
+		params->MinMaxOutput[mip] = builder.CreateUAV(FRDGTextureUAVDesc{ pyramid.MinMax, static_cast<uint8>(mip) });
+		params->CheckerboardOutput[mip] = builder.CreateUAV(FRDGTextureUAVDesc{ pyramid.Checkerboard, static_cast<uint8>(mip) });
+	}
+	params->GroupCounter = groupCounterUAV;
+
+	FComputeShaderUtils::AddPass(
+		builder,
+		RDG_EVENT_NAME("EGP_DepthPyramid %dx%d (%d mips)",
+					   pyramid.Mip0Size.X, pyramid.Mip0Size.Y, pyramid.NumMips),
+		passFlags,
+		TShaderMapRef<FEGPDepthPyramidCS>{ view.ShaderMap },
+		params, groupCount
+	);
+
+	return pyramid;
+}
+
+
+//Depth pyramids that have already been built in the current graph.
+struct FEGPDepthPyramidCache
+{
+	TMap<TPair<const FViewInfo*, FRDGTextureRef>, EGP::FDepthPyramid> Pyramids;
+};
+RDG_REGISTER_BLACKBOARD_STRUCT(FEGPDepthPyramidCache);
+
+EGP::FDepthPyramid EGP::GetDepthPyramid(FRDGBuilder& builder, const FViewInfo& view,
+										  FRDGTextureRef sceneDepth)
+{
+	auto* cache = builder.Blackboard.GetMutable<FEGPDepthPyramidCache>();
+	if (cache == nullptr)
+		cache = &builder.Blackboard.Create<FEGPDepthPyramidCache>();
+
+	const auto key = MakeTuple(&view, sceneDepth);
+	if (auto* found = cache->Pyramids.Find(key))
+		return *found;
+
+	return cache->Pyramids.Add(key, AddDepthPyramidPass(builder, view, sceneDepth));
+}
@@ -1,10 +1,13 @@
 #include "EGP_DownsampleDepthPass.h"
 
 #include "DataDrivenShaderPlatformInfo.h"
+#include "RenderGraphBlackboard.h"
 #include "Runtime/Renderer/Private/SceneRendering.h"
 
+#include "EGP_DepthPyramid.h"
 
-//This file contains a literal copy-paste of the Unreal implementation,
+
+//The first part of this file is a literal copy-paste of the Unreal implementation,
 //    with tiny changes clearly noted by comments.
 #pragma warning( push, 0 )
 // ReSharper disable All
@@ -106,3 +109,161 @@ void EGP::AddDownsampleDepthPass(FRDGBuilder& GraphBuilder, const FViewInfo& Vie
 }
 
 #pragma warning( pop )
+
+
+//Writes one mip of a depth pyramid into a depth-stencil target of some other resolution,
+//    reducing every pyramid texel that overlaps each output pixel so the result stays conservative.
+class FEGPCopyDepthPyramidPS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FEGPCopyDepthPyramidPS);
+	SHADER_USE_PARAMETER_STRUCT(FEGPCopyDepthPyramidPS, FGlobalShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE_SRV(Texture2D<float2>, PyramidMip)
+		SHADER_PARAMETER(FUintVector2, PyramidMipSize)
+		SHADER_PARAMETER(FVector2f, DstToSrcPixelScale)
+		SHADER_PARAMETER(uint32, UseCheckerboard)
+		RENDER_TARGET_BINDING_SLOTS()
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& params)
+	{
+		return IsFeatureLevelSupported(params.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FEGPCopyDepthPyramidPS, "/EGP/DepthPyramid/depth_pyramid_copy_ps.usf", "MainPS", SF_Pixel);
+
+namespace
+{
+	void AddCopyDepthPyramidPass(FRDGBuilder& builder, const FViewInfo& view,
+								 const EGP::FDepthPyramid& pyramid, FRDGTextureRef output,
+								 EDownsampleDepthFilter sampling)
+	{
+		const FIntPoint resolution = output->Desc.Extent;
+		const int mip = pyramid.GetMipForResolution(resolution);
+		const FIntPoint mipSize = pyramid.GetMipSize(mip);
+
+		auto* params = builder.AllocParameters<FEGPCopyDepthPyramidPS::FParameters>();
+		params->PyramidMip = builder.CreateSRV(FRDGTextureSRVDesc::CreateForMipLevel(pyramid.MinMax, mip));
+		params->PyramidMipSize = FUintVector2(mipSize.X, mipSize.Y);
+		params->DstToSrcPixelScale = FVector2f{ mipSize } / FVector2f{ resolution };
+		params->UseCheckerboard = (sampling == EDownsampleDepthFilter::Checkerboard) ? 1 : 0;
+		params->RenderTargets.DepthStencil = FDepthStencilBinding(
+			output,
+			ERenderTargetLoadAction::ENoAction, ERenderTargetLoadAction::ENoAction,
+			FExclusiveDepthStencil::DepthWrite_StencilWrite
+		);
+
+		AddDrawScreenPass(
+			builder,
+			RDG_EVENT_NAME("EGP_CopyDepthPyramid mip %d (%dx%d) -> %dx%d",
+						   mip, mipSize.X, mipSize.Y, resolution.X, resolution.Y),
+			view,
+			FScreenPassTextureViewport{ FIntRect{ FIntPoint::ZeroValue, resolution } },
+			FScreenPassTextureViewport{ FIntRect{ FIntPoint::ZeroValue, mipSize } },
+			TShaderMapRef<FScreenPassVS>{ view.ShaderMap },
+			TShaderMapRef<FEGPCopyDepthPyramidPS>{ view.ShaderMap },
+			TStaticDepthStencilState<true, CF_Always>::GetRHI(),
+			params
+		);
+	}
+}
+
+
+//Downsampled depth textures that have already been made in the current graph.
+//The RDG blackboard lives exactly as long as the graph, so this cache is naturally per-frame.
+struct FEGPDownsampledDepthCache
+{
+	struct FKey
+	{
+		const FViewInfo* View;
+		FRDGTextureRef SourceDepth;
+		FIntPoint Resolution;
+		EDownsampleDepthFilter Filter;
+
+		bool operator==(const FKey& k2) const
+		{
+			return View == k2.View && SourceDepth == k2.SourceDepth &&
+				   Resolution == k2.Resolution && Filter == k2.Filter;
+		}
+		friend uint32 GetTypeHash(const FKey& k)
+		{
+			return HashCombine(
+				HashCombine(GetTypeHash(k.View), GetTypeHash(k.SourceDepth)),
+				HashCombine(GetTypeHash(k.Resolution), GetTypeHash(static_cast<uint32>(k.Filter)))
+			);
+		}
+	};
+	TMap<FKey, FRDGTextureRef> Textures;
+};
+RDG_REGISTER_BLACKBOARD_STRUCT(FEGPDownsampledDepthCache);
+
+FRDGTextureRef EGP::GetDownsampledDepth(FRDGBuilder& builder, const FViewInfo& view,
+										 FRDGTextureRef sceneDepth, const FIntPoint& resolution,
+										 EDownsampleDepthFilter sampling)
+{
+	const bool isWholeTexture = view.ViewRect.Min == FIntPoint::ZeroValue &&
+								view.ViewRect.Size() == sceneDepth->Desc.Extent;
+
+	//If the depth buffer is already the right size and placement, there's nothing to do.
+	//'MinAndMaxDepth' outputs a color texture though, so it always needs a pass.
+	if (sampling != EDownsampleDepthFilter::MinAndMaxDepth &&
+		view.ViewRect.Min == FIntPoint::ZeroValue && sceneDepth->Desc.Extent == resolution)
+	{
+		return sceneDepth;
+	}
+
+	//The engine may have already point-sampled the scene depth down to half-resolution
+	//    (for separate translucency); if that's exactly what was asked for, use it.
+	if (sampling == EDownsampleDepthFilter::Point && isWholeTexture)
+	{
+		const auto& sceneTextures = view.GetSceneTextures();
+		if (HasBeenProduced(sceneTextures.SmallDepth) &&
+			sceneTextures.SmallDepth->Desc.Extent == resolution)
+		{
+			return sceneTextures.SmallDepth;
+		}
+	}
+
+	auto* cache = builder.Blackboard.GetMutable<FEGPDownsampledDepthCache>();
+	if (cache == nullptr)
+		cache = &builder.Blackboard.Create<FEGPDownsampledDepthCache>();
+
+	const FEGPDownsampledDepthCache::FKey key{ &view, sceneDepth, resolution, sampling };
+	if (auto* found = cache->Textures.Find(key))
+		return *found;
+
+	FRDGTextureDesc desc;
+	if (sampling == EDownsampleDepthFilter::MinAndMaxDepth)
+	{
+		desc = FRDGTextureDesc::Create2D(resolution, PF_G32R32F, FClearValueBinding::None,
+										 TexCreate_RenderTargetable | TexCreate_ShaderResource);
+	}
+	else
+	{
+		desc = sceneDepth->Desc;
+		desc.Extent = resolution;
+	}
+	FRDGTextureRef output = builder.CreateTexture(desc, TEXT("EGP_DownsampledSceneDepth"));
+
+	//The 'Max' and 'Checkerboard' filters can be read straight out of the shared depth pyramid,
+	//    which is much cheaper than another full-resolution pass once anything else has asked for the pyramid.
+	if (sampling == EDownsampleDepthFilter::Max || sampling == EDownsampleDepthFilter::Checkerboard)
+	{
+		AddCopyDepthPyramidPass(builder, view, GetDepthPyramid(builder, view, sceneDepth), output, sampling);
+	}
+	else
+	{
+		AddDownsampleDepthPass(
+			builder, view,
+			FScreenPassTexture{ sceneDepth, view.ViewRect },
+			FScreenPassRenderTarget{ output, ERenderTargetLoadAction::ENoAction },
+			sampling
+		);
+	}
+
+	cache->Textures.Add(key, output);
+	return output;
+}
@@ -0,0 +1,33 @@
+#include "EGP_FusedSimulation.h"
+
+#include "MaterialCompiler.h"
+
+
+static_assert(EGP::MaxFusedSimulationStages == 8,
+			  "Update the 'Stage' clamp in UMaterialExpressionEGPFusedStageOutputs and the stages in fused.ush");
+static_assert(EGP::FusedSimulationOutputsPerStage == 4,
+			  "Update the inputs of UMaterialExpressionEGPFusedStageOutputs and the outputs in fused.ush");
+
+
+#if WITH_EDITOR
+int32 UMaterialExpressionEGPFusedStageOutputs::Compile(FMaterialCompiler* compiler, int32 pinIdx)
+{
+	FExpressionInput* pins[] = { &Value0, &Value1, &Value2, &Value3 };
+
+	int32 codeID = INDEX_NONE;
+	if (pinIdx >= 0 && pinIdx < UE_ARRAY_COUNT(pins) && pins[pinIdx]->IsConnected())
+		codeID = compiler->ValidCast(pins[pinIdx]->Compile(compiler), MCT_Float4);
+
+	return compiler->CustomOutput(this, pinIdx, codeID);
+}
+#endif
+
+
+void EGP::FFusedSimulationShader::ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& params,
+																FShaderCompilerEnvironment& env)
+{
+	FSimulationShader::ModifyCompilationEnvironment(params, env);
+	env.SetDefine(TEXT("EGP_IS_FUSED_SIMULATION"), 1);
+	env.SetDefine(TEXT("EGP_MAX_FUSED_STAGES"), MaxFusedSimulationStages);
+	env.SetDefine(TEXT("EGP_FUSED_OUTPUTS_PER_STAGE"), FusedSimulationOutputsPerStage);
+}
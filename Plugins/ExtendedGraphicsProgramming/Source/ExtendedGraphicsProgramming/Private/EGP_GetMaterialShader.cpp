@@ -8,3 +8,121 @@ TOptional<EGP::FShaderMapFindResult> EGP::FindMaterialShaders_RenderThread(const
 	return FindMaterialShaders_RenderThread(uMaterial, shaderTypes, settings,
 											[&](const FShaderMapFindCandidate&) { return true; });
 }
+
+
+namespace
+{
+	//Everything that picks a particular set of shaders out of one Material render proxy.
+	struct FShaderCacheQuery
+	{
+		FMaterialShaderTypes ShaderTypes;
+		TOptional<EMaterialDomain> Domain;
+		ERHIFeatureLevel::Type FeatureLevel;
+		const FVertexFactoryType* VertexFactory;
+
+		bool operator==(const FShaderCacheQuery& q2) const
+		{
+			if (Domain != q2.Domain || FeatureLevel != q2.FeatureLevel || VertexFactory != q2.VertexFactory ||
+				ShaderTypes.PipelineType != q2.ShaderTypes.PipelineType)
+			{
+				return false;
+			}
+			for (int i = 0; i < SF_NumFrequencies; ++i)
+				if (ShaderTypes.ShaderType[i] != q2.ShaderTypes.ShaderType[i] ||
+					(ShaderTypes.ShaderType[i] != nullptr && ShaderTypes.PermutationId[i] != q2.ShaderTypes.PermutationId[i]))
+				{
+					return false;
+				}
+			return true;
+		}
+	};
+
+	struct FShaderCacheEntry
+	{
+		FShaderCacheQuery Query;
+		EGP::FShaderMapFindResult Result;
+
+		//The shader map this entry was resolved from, which identifies one compile of the Material.
+		//Holding a reference means its address can't be reused by a later compile,
+		//    so comparing pointers is enough to notice the Material was recompiled.
+		TRefCountPtr<FMaterialShaderMap> ShaderMap;
+
+		//The entry is checked against the Material at most once per frame,
+		//    as shader maps are only swapped between frames.
+		uint64 ValidatedFrame;
+	};
+
+	//Entries not used for this many frames are dropped, so that destroyed Materials don't pile up.
+	constexpr uint64 ShaderCacheExpirationFrames = 600;
+
+	//Keyed by the Material's render proxy, so a lookup is a pointer hash;
+	//    each proxy usually has only a couple of entries (one per pass using it), which are searched linearly.
+	TMap<const FMaterialRenderProxy*, TArray<FShaderCacheEntry, TInlineAllocator<2>>> ShaderCache_RenderThread;
+	uint64 ShaderCacheLastPruneFrame_RenderThread = 0;
+}
+
+TOptional<EGP::FShaderMapFindResult> EGP::FindMaterialShadersCached_RenderThread(const UMaterialInterface* uMaterial,
+																				 const FMaterialShaderTypes& shaderTypes,
+																				 FShaderMapFindSettings settings)
+{
+	if (uMaterial == nullptr)
+		if (settings.Domain.IsSet())
+			uMaterial = UMaterial::GetDefaultMaterial(*settings.Domain);
+		else
+			return NullOpt;
+
+	return FindMaterialShadersCached_RenderThread(uMaterial->GetRenderProxy(), shaderTypes, settings);
+}
+TOptional<EGP::FShaderMapFindResult> EGP::FindMaterialShadersCached_RenderThread(const FMaterialRenderProxy* rootProxy,
+																				 const FMaterialShaderTypes& shaderTypes,
+																				 FShaderMapFindSettings settings)
+{
+	check(IsInRenderingThread());
+	check(rootProxy);
+	const uint64 frame = GFrameCounterRenderThread;
+
+	//Occasionally clean up old entries.
+	if (frame >= ShaderCacheLastPruneFrame_RenderThread + ShaderCacheExpirationFrames)
+	{
+		ShaderCacheLastPruneFrame_RenderThread = frame;
+		for (auto it = ShaderCache_RenderThread.CreateIterator(); it; ++it)
+		{
+			it.Value().RemoveAllSwap([&](const FShaderCacheEntry& e) { return frame > e.ValidatedFrame + ShaderCacheExpirationFrames; });
+			if (it.Value().IsEmpty())
+				it.RemoveCurrent();
+		}
+	}
+
+	//Use the cached result if it's still valid.
+	const FShaderCacheQuery query{ shaderTypes, settings.Domain, settings.FeatureLevel, settings.VertexFactory };
+	auto& entries = ShaderCache_RenderThread.FindOrAdd(rootProxy);
+	const int32 entryIdx = entries.IndexOfByPredicate([&](const FShaderCacheEntry& e) { return e.Query == query; });
+	if (entryIdx != INDEX_NONE)
+	{
+		auto& entry = entries[entryIdx];
+		if (entry.ValidatedFrame == frame)
+			return entry.Result;
+
+		const FMaterial* rootMaterial = rootProxy->GetMaterialNoFallback(settings.FeatureLevel);
+		if (rootMaterial == entry.Result.Material &&
+			rootMaterial->GetRenderingThreadShaderMap() == entry.ShaderMap.GetReference())
+		{
+			entry.ValidatedFrame = frame;
+			return entry.Result;
+		}
+		entries.RemoveAtSwap(entryIdx);
+	}
+
+	//Resolve it, and only cache the result if it came from the Material itself.
+	auto result = FindMaterialShaders_RenderThread(rootProxy, shaderTypes, settings,
+												   [&](const FShaderMapFindCandidate&) { return true; });
+	if (result.IsSet() && result->MaterialProxy == rootProxy)
+	{
+		entries.Add({ query, *result, const_cast<FMaterialShaderMap*>(result->Map), frame });
+	}
+	else if (entries.IsEmpty())
+	{
+		ShaderCache_RenderThread.Remove(rootProxy);
+	}
+	return result;
+}
@@ -1,5 +1,12 @@
 #include "EGP_GetMeshBatches.h"
 
+#include "InstanceCulling/InstanceCullingManager.h"
+#include "MaterialDomain.h"
+#include "MaterialShared.h"
+#include "MeshMaterialShader.h"
+#include "Materials/MaterialInterface.h"
+#include "UObject/UObjectIterator.h"
+
 
 uint64 EGP::GetStaticMeshElements(const FSceneView& view, const FPrimitiveSceneProxy* proxy,
                                   TArray<FMeshBatch>& output)
@@ -29,3 +36,172 @@ FInt32Range EGP::GetDynamicMeshElementRange(const FViewInfo& info, uint32 primit
 
 	return FInt32Range::Empty();
 }
+
+FLODMask EGP::ComputeStaticMeshLOD(const FViewInfo& view, const FPrimitiveSceneInfo& primitive,
+								   const FMeshPassLODSettings& settings)
+{
+	//Same setup as the engine's own static-mesh LOD selection in the visibility pass.
+	const int32 forcedLOD = view.Family->EngineShowFlags.LOD ? GetCVarForceLOD() : 0;
+	const auto& bounds = primitive.Proxy->GetBounds();
+	float screenRadiusSquared = 0;
+	FLODMask lod = ComputeLODForMeshes(
+		primitive.StaticMeshRelevances, view,
+		bounds.Origin, static_cast<float>(bounds.SphereRadius),
+		forcedLOD, screenRadiusSquared,
+		primitive.Proxy->GetCurrentFirstLODIdx_RenderThread(),
+		settings.ScreenSizeScale
+	);
+
+	if (settings.LODBias != 0)
+	{
+		int8 maxLOD = 0;
+		for (const auto& relevance : primitive.StaticMeshRelevances)
+			maxLOD = FMath::Max(maxLOD, relevance.LODIndex);
+
+		//Dithered transitions are dropped here; a biased LOD doesn't need to blend with its neighbor.
+		const int biasedLOD = FMath::Max(lod.DitheredLODIndices[0], lod.DitheredLODIndices[1]) + settings.LODBias;
+		lod.SetLOD(FMath::Clamp(biasedLOD, 0, static_cast<int>(maxLOD)));
+	}
+
+	return lod;
+}
+
+uint64 EGP::GetStaticMeshElementMask(const FViewInfo& view, const FStaticMeshBatch& staticMesh)
+{
+	//Some meshes (e.g. instanced ones on older paths) cull their elements individually;
+	//    the view stores the result for them.
+	if (staticMesh.bRequiresPerElementVisibility)
+		return view.StaticMeshBatchVisibility[staticMesh.BatchVisibilityId];
+
+	return GetAllElementsMask(staticMesh);
+}
+
+FInstanceCullingManager* EGP::GetInstanceCullingManager(const FViewInfo& view)
+{
+	if (!UseGPUScene(view.GetShaderPlatform(), view.GetFeatureLevel()))
+		return nullptr;
+
+	//Views that were never registered with GPU-Scene (some editor and capture views) can't be culled by it.
+	if (view.GPUSceneViewId == INDEX_NONE)
+		return nullptr;
+
+	//The engine doesn't hand the culling manager to scene-view extensions,
+	//    so reach it through the renderer that owns this view family.
+	if (view.Family == nullptr || !view.Family->bIsViewFamilyInfo)
+		return nullptr;
+	auto* sceneRenderer = static_cast<const FViewFamilyInfo*>(view.Family)->GetSceneRenderer();
+	if (sceneRenderer == nullptr)
+		return nullptr;
+
+	auto& manager = sceneRenderer->InstanceCullingManager;
+	return manager.IsEnabled() ? &manager : nullptr;
+}
+
+bool EGP::ShouldCompileCustomMeshPassPermutation(const FMeshMaterialShaderPermutationParameters& params,
+												 bool allowTranslucent)
+{
+	//Vertex factories for the kinds of primitives a custom pass normally draws.
+	//Particle sprites, hair, water, Nanite etc. are left out.
+	static const TSet<FName> allowedVertexFactories = {
+		TEXT("FLocalVertexFactory"),
+		TEXT("FInstancedStaticMeshVertexFactory"),
+		TEXT("FSplineMeshVertexFactory"),
+		TEXT("TGPUSkinVertexFactoryDefault"),
+		TEXT("TGPUSkinVertexFactoryUnlimited"),
+		TEXT("FGPUSkinPassthroughVertexFactory"),
+		TEXT("FLandscapeVertexFactory"),
+		TEXT("FLandscapeFixedGridVertexFactory"),
+		TEXT("FLandscapeXYOffsetVertexFactory"),
+		TEXT("FNiagaraMeshVertexFactory"),
+	};
+
+	const auto& material = params.MaterialParameters;
+	if (material.MaterialDomain != MD_Surface)
+		return false;
+	if (!material.bIsDefaultMaterial && !allowTranslucent && !IsOpaqueOrMaskedBlendMode(material.BlendMode))
+		return false;
+	return params.VertexFactoryType != nullptr &&
+		   allowedVertexFactories.Contains(params.VertexFactoryType->GetFName());
+}
+
+//Measures how much a custom mesh pass adds to the loaded shader maps,
+//    e.g. to compare before and after changing 'ShouldCompileCustomMeshPassPermutation()'.
+static FAutoConsoleCommandWithArgsAndOutputDevice CmdEGPCountMeshPassShaders(
+	TEXT("r.EGP.CountMeshPassShaders"),
+	TEXT("Counts the loaded Material shader maps, and their vertex factories, that contain the given mesh shader types. ")
+		TEXT("Usage: r.EGP.CountMeshPassShaders FGoLMeshPS [FBreMeshPS ...]"),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& args, FOutputDevice& output)
+	{
+		for (const FString& typeName : args)
+		{
+			const FShaderType* shaderType = FShaderType::GetShaderTypeByName(*typeName);
+			if (shaderType == nullptr || shaderType->GetMeshMaterialShaderType() == nullptr)
+			{
+				output.Logf(TEXT("'%s' is not a mesh material shader type"), *typeName);
+				continue;
+			}
+
+			//Material instances without static overrides share their parent's shader map, so count maps, not Materials.
+			TSet<const FMaterialShaderMap*> shaderMaps;
+			for (TObjectIterator<UMaterialInterface> it; it; ++it)
+			{
+				const FMaterialResource* resource = it->GetMaterialResource(GMaxRHIFeatureLevel);
+				if (resource != nullptr && resource->GetGameThreadShaderMap() != nullptr)
+					shaderMaps.Add(resource->GetGameThreadShaderMap());
+			}
+
+			int32 nMapsWithShader = 0,
+				  nVertexFactoryPairs = 0,
+				  nVertexFactoryPairsWithShader = 0;
+			for (const FMaterialShaderMap* shaderMap : shaderMaps)
+			{
+				bool hasShader = false;
+				for (FVertexFactoryType* vertexFactoryType : FVertexFactoryType::GetSortedMaterialTypes())
+				{
+					const auto* meshShaderMap = shaderMap->GetMeshShaderMap(vertexFactoryType);
+					if (meshShaderMap == nullptr)
+						continue;
+
+					nVertexFactoryPairs += 1;
+					if (meshShaderMap->GetShader(shaderType) != nullptr)
+					{
+						nVertexFactoryPairsWithShader += 1;
+						hasShader = true;
+					}
+				}
+				nMapsWithShader += hasShader ? 1 : 0;
+			}
+
+			output.Logf(TEXT("%s: in %i of %i shader maps, and %i of %i (shader map, vertex factory) pairs"),
+						*typeName, nMapsWithShader, shaderMaps.Num(),
+						nVertexFactoryPairsWithShader, nVertexFactoryPairs);
+		}
+	})
+);
+
+bool EGP::FindMeshPassShaders(const FMeshBatch& batch, ERHIFeatureLevel::Type featureLevel,
+							  const FMaterialShaderTypes& shaderTypes,
+							  bool fallBackToDefaultMaterial,
+							  const FMaterialRenderProxy*& outMaterialProxy,
+							  const FMaterial*& outMaterial,
+							  FMaterialShaders& outShaders)
+{
+	auto* vertexFactoryType = batch.VertexFactory->GetType();
+
+	//Get the first usable Material in the chain,
+	//    starting at the batch's desired Material and ending at the Default Material.
+	const FMaterialRenderProxy* fallbackProxy = nullptr;
+	outMaterial = &batch.MaterialRenderProxy->GetMaterialWithFallback(featureLevel, fallbackProxy);
+	outMaterialProxy = fallbackProxy ? fallbackProxy : batch.MaterialRenderProxy;
+	if (outMaterial->TryGetShaders(shaderTypes, vertexFactoryType, outShaders))
+		return true;
+	if (!fallBackToDefaultMaterial)
+		return false;
+
+	//That Material doesn't have our shaders, so try the default one.
+	const FMaterialRenderProxy* defaultProxy = UMaterial::GetDefaultMaterial(MD_Surface)->GetRenderProxy();
+	fallbackProxy = nullptr;
+	outMaterial = &defaultProxy->GetMaterialWithFallback(featureLevel, fallbackProxy);
+	outMaterialProxy = fallbackProxy ? fallbackProxy : defaultProxy;
+	return outMaterial->TryGetShaders(shaderTypes, vertexFactoryType, outShaders);
+}
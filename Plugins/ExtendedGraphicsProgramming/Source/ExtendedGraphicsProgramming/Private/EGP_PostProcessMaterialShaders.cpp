@@ -1,6 +1,8 @@
 #include "EGP_PostProcessMaterialShaders.h"
 
+#include "CommonRenderResources.h"
 #include "DataDrivenShaderPlatformInfo.h"
+#include "PipelineStateCache.h"
 #include "PostProcess/PostProcessMaterialInputs.h"
 #include "Runtime/Renderer/Private/SceneTextureParameters.h"
 #include "SystemTextures.h"
@@ -89,3 +91,44 @@ void EGP::FScreenSpaceShader::SetParameters(FRHIBatchedShaderParameters& paramBa
 }
 
 IMPLEMENT_SHADER_TYPE(, EGP::FScreenSpaceRenderVS, TEXT("/EGP/ScreenPass/simple_vs.usf"), TEXT("MainVS"), SF_Vertex);
+
+
+bool EGP::impl::IsFromOwnMaterial(const FShaderMapFindResult& found,
+								  const UMaterialInterface* material,
+								  ERHIFeatureLevel::Type featureLevel)
+{
+	//A null Material means the default one was asked for.
+	if (material == nullptr)
+		material = UMaterial::GetDefaultMaterial(MD_PostProcess);
+	return found.Material == material->GetRenderProxy()->GetMaterialNoFallback(featureLevel);
+}
+void EGP::impl::PrecacheComputePSO(FRHIComputeShader* shader)
+{
+	if (PipelineStateCache::IsPSOPrecachingEnabled())
+		PipelineStateCache::PrecacheComputePipelineState(shader);
+}
+void EGP::impl::PrecacheScreenPassPSO(FRHIVertexShader* shaderV, FRHIPixelShader* shaderP,
+									  const FScreenSpacePassRenderState& state,
+									  EPixelFormat outputFormat, ETextureCreateFlags outputFlags,
+									  uint8 numSamples)
+{
+	if (!PipelineStateCache::IsPSOPrecachingEnabled())
+		return;
+
+	//Match the pipeline that 'AddDrawScreenPass()' will set up.
+	FGraphicsPipelineStateInitializer pso;
+	pso.BoundShaderState.VertexDeclarationRHI = GFilterVertexDeclaration.VertexDeclarationRHI;
+	pso.BoundShaderState.VertexShaderRHI = shaderV;
+	pso.BoundShaderState.PixelShaderRHI = shaderP;
+	pso.BlendState = state.BlendState;
+	pso.DepthStencilState = state.DepthStencilState;
+	pso.RasterizerState = TStaticRasterizerState<>::GetRHI();
+	pso.PrimitiveType = PT_TriangleList;
+	pso.RenderTargetsEnabled = 1;
+	pso.RenderTargetFormats[0] = outputFormat;
+	pso.RenderTargetFlags[0] = outputFlags;
+	pso.NumSamples = numSamples;
+	pso.StatePrecachePSOHash = RHIComputeStatePrecachePSOHash(pso);
+
+	PipelineStateCache::PrecacheGraphicsPipelineState(pso);
+}
@@ -0,0 +1,61 @@
+#include "EGP_Scalability.h"
+
+#include "Scalability.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/ConfigUtilities.h"
+#include "Misc/DelayedAutoRegister.h"
+
+
+static void ApplyEGPQualityLevel(IConsoleVariable* cvar)
+{
+	const int32 level = FMath::Clamp(cvar->GetInt(), 0, EGP::NumQualityLevels - 1);
+	UE::ConfigUtilities::ApplyCVarSettingsFromIni(*FString::Printf(TEXT("EGPQuality@%i"), level),
+												  *GScalabilityIni, ECVF_SetByScalability);
+}
+static TAutoConsoleVariable<int32> CVarEGPQuality(
+	TEXT("sg.EGPQuality"),
+	3,
+	TEXT("Scalability quality of the EGP render passes: 0 = low, 1 = medium, 2 = high, 3 = epic, 4 = cinematic.\n")
+	TEXT("Applies the [EGPQuality@N] section of Scalability.ini to the passes' cvars."),
+	FConsoleVariableDelegate::CreateStatic(&ApplyEGPQualityLevel),
+	ECVF_ScalabilityGroup
+);
+
+int32 EGP::GetQualityLevel()
+{
+	return CVarEGPQuality.GetValueOnAnyThread();
+}
+
+//Where 'SetQualityLevel()' saves the player's choice, in GameUserSettings.ini.
+static const TCHAR* const EGPQualitySettingsSection = TEXT("EGP.Scalability");
+static const TCHAR* const EGPQualitySettingsKey = TEXT("EGPQuality");
+
+void EGP::SetQualityLevel(int32 level)
+{
+	check(IsInGameThread());
+	level = FMath::Clamp(level, 0, NumQualityLevels - 1);
+	CVarEGPQuality->Set(level, ECVF_SetByGameSetting);
+
+	GConfig->SetInt(EGPQualitySettingsSection, EGPQualitySettingsKey, level, GGameUserSettingsIni);
+	GConfig->Flush(false, GGameUserSettingsIni);
+}
+
+//Until the player picks an EGP quality level, it follows the engine's effects quality,
+//    so the overall scalability setting (e.g. 'UGameUserSettings::SetOverallScalabilityLevel()') covers EGP too.
+static void FollowEngineQualityLevels(const Scalability::FQualityLevels& levels)
+{
+	if ((CVarEGPQuality->GetFlags() & ECVF_SetByMask) > ECVF_SetByScalability)
+		return;
+	CVarEGPQuality->Set(FMath::Clamp(levels.EffectsQuality, 0, EGP::NumQualityLevels - 1), ECVF_SetByScalability);
+}
+static FDelayedAutoRegisterHelper RegisterEGPQualityLevel(EDelayedRegisterRunPhase::EndOfEngineInit, []
+{
+	//Restore the player's saved choice.
+	int32 savedLevel;
+	if (GConfig->GetInt(EGPQualitySettingsSection, EGPQualitySettingsKey, savedLevel, GGameUserSettingsIni))
+		CVarEGPQuality->Set(FMath::Clamp(savedLevel, 0, EGP::NumQualityLevels - 1), ECVF_SetByGameSetting);
+	else
+		FollowEngineQualityLevels(Scalability::GetQualityLevels());
+
+	Scalability::OnScalabilitySettingsChanged.AddStatic(&FollowEngineQualityLevels);
+});
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <atomic>
+
 #include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Math/GenericOctree.h"
 #include "SceneViewExtension.h"
 #include "Runtime/Renderer/Private/SceneRendering.h"
 
@@ -21,14 +25,14 @@ namespace EGP
 {
 	//A whitelist OR blacklist of some objects.
 	//You can pick which on construction, or after adding your first object.
-	template<typename T, typename CompareFn = std::equal_to<T>>
+	//
+	//Elements are hashed, so lookups stay cheap no matter how long the list gets.
+	template<typename T, typename KeyFuncs = DefaultKeyFuncs<T>>
 	class FilterList
 	{
 	public:
 		FilterList(TOptional<bool> _isWhitelist = NullOpt)
 			: isWhitelist(_isWhitelist) { }
-		FilterList(CompareFn comparator, TOptional<bool> _isWhitelist = NullOpt)
-			: Comparator(std::move(comparator)), isWhitelist(_isWhitelist) { }
 
 		//If this list hasn't been configured (not whitelist or blacklist), then it allows everything.
 		bool IsAllowed(const T& t) const
@@ -36,16 +40,8 @@ namespace EGP
 			if (!isWhitelist.IsSet())
 				return true;
 
-			bool isListed = false;
-			for (const T& element : elements)
-			{
-				if (Comparator(element, t))
-				{
-					isListed = true;
-					break;
-				}
-			}
-			
+			//An empty whitelist or blacklist doesn't need to hash anything.
+			const bool isListed = !elements.IsEmpty() && elements.Contains(t);
 			return isListed == *isWhitelist;
 		}
 
@@ -66,10 +62,7 @@ namespace EGP
 		}
 		void Remove(const T& t)
 		{
-			elements.RemoveAll([&](const T& t2)
-			{
-				return Comparator(t, t2);
-			});
+			elements.Remove(t);
 		}
 
 		//Updates this filter to be a blacklist or whitelist, without changing its elements.
@@ -83,10 +76,23 @@ namespace EGP
 
 		size_t GetSize() const { return elements.Num(); }
 
-		CompareFn Comparator;
 	private:
 		TOptional<bool> isWhitelist;
-		TArray<T> elements;
+		TSet<T, KeyFuncs> elements;
+	};
+
+	//Every filter list of a 'U_EGP_ViewFilter'.
+	//The render thread only ever sees immutable copies of this.
+	struct FViewFilterSnapshot
+	{
+		FilterList<const FRenderTarget*> ByRenderTarget;
+		FilterList<const FSceneInterface*> ByScene;
+		FilterList<const FViewport*> ByViewport;
+		FilterList<TWeakObjectPtr<const AActor>> ByViewActor;
+		FilterList<int> ByPlayerIndex;
+
+		//Increases with each published snapshot.
+		uint32 Version = 0;
 	};
 }
 
@@ -112,7 +118,7 @@ public:
 	//The actors that get tested against this filter are usually PlayerControllers
 	//    or the target of their PlayerCameraManager if that exists.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Actor")
-	void FilterByActor(const AActor* actor, bool isWhitelist = true) { UpdateFilterList(byViewActor_GT, byViewActor_RT, { actor }, true, isWhitelist); }
+	void FilterByActor(const AActor* actor, bool isWhitelist = true) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByViewActor, { actor }, true, isWhitelist); }
 	//Removes the given viewport actor from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
@@ -121,75 +127,75 @@ public:
 	//The actors that get tested against this filter are usually PlayerControllers
 	//    or the target of their PlayerCameraManager if that exists.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Actor")
-	void RemoveByActor(const AActor* actor) { UpdateFilterList(byViewActor_GT, byViewActor_RT, { actor }, false, false); }
+	void RemoveByActor(const AActor* actor) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByViewActor, { actor }, false, false); }
 	//Sets the actor filter to be a blacklist or whitelist.
 	//
 	//This can also be done automatically when adding the first element to the filter.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Actor")
-	void ConfigureByActor(bool isWhitelist) { ConfigureFilterList(byViewActor_GT, byViewActor_RT, isWhitelist); }
+	void ConfigureByActor(bool isWhitelist) { ConfigureFilterList(&EGP::FViewFilterSnapshot::ByViewActor, isWhitelist); }
 	//Clears all filtering by viewport actor, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Actor")
-	void ClearsByActor() { ClearFilterList(byViewActor_GT, byViewActor_RT); }
+	void ClearsByActor() { ClearFilterList(&EGP::FViewFilterSnapshot::ByViewActor); }
 
 	//Adds the given player controller index to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Player Index")
-	void FilterByPlayerIdx(int playerIdx, bool isWhitelist = true) { UpdateFilterList(byPlayerIndex_GT, byPlayerIndex_RT, playerIdx, true, isWhitelist); }
+	void FilterByPlayerIdx(int playerIdx, bool isWhitelist = true) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByPlayerIndex, playerIdx, true, isWhitelist); }
 	//Removes the given player controller index from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
 	//Does nothing if the index isn't in the list.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Player Index")
-	void RemoveByPlayerIdx(int playerIdx) { UpdateFilterList(byPlayerIndex_GT, byPlayerIndex_RT, playerIdx, false, false); }
+	void RemoveByPlayerIdx(int playerIdx) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByPlayerIndex, playerIdx, false, false); }
 	//Sets the player-index filter to be a blacklist or whitelist.
 	//
 	//This can also be done automatically when adding the first element to the filter.
 	//This can't be done after an element has been added.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Player Index")
-	void ConfigureByPlayerIdx(bool isWhitelist) { ConfigureFilterList(byPlayerIndex_GT, byPlayerIndex_RT, isWhitelist); }
+	void ConfigureByPlayerIdx(bool isWhitelist) { ConfigureFilterList(&EGP::FViewFilterSnapshot::ByPlayerIndex, isWhitelist); }
 	//Clears all filtering by player index, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Player Index")
-	void ClearsByPlayerIdx() { ClearFilterList(byPlayerIndex_GT, byPlayerIndex_RT); }
+	void ClearsByPlayerIdx() { ClearFilterList(&EGP::FViewFilterSnapshot::ByPlayerIndex); }
 
 	//Adds the given viewport to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
-	void FilterByViewport(const FViewport* viewport, bool isWhitelist = true) { UpdateFilterList(byViewport_GT, byViewport_RT, viewport, true, isWhitelist); }
+	void FilterByViewport(const FViewport* viewport, bool isWhitelist = true) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByViewport, viewport, true, isWhitelist); }
 	//Removes the give viewport from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
 	//Does nothing if the index isn't in the list.
-	void RemoveByViewport(const FViewport* viewport) { UpdateFilterList(byViewport_GT, byViewport_RT, viewport, false, false); }
+	void RemoveByViewport(const FViewport* viewport) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByViewport, viewport, false, false); }
 	//Sets the viewport filter to be a blacklist or whitelist.
 	//
 	//This can also be done automatically when adding the first element to the filter.
 	//This can't be done after an element has been added.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Viewport")
-	void ConfigureByViewport(bool isWhitelist) { ConfigureFilterList(byViewport_GT, byViewport_RT, isWhitelist); }
+	void ConfigureByViewport(bool isWhitelist) { ConfigureFilterList(&EGP::FViewFilterSnapshot::ByViewport, isWhitelist); }
 	//Clears all filtering by viewport reference, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Viewport")
-	void ClearsByViewport() { ClearFilterList(byViewport_GT, byViewport_RT); }
+	void ClearsByViewport() { ClearFilterList(&EGP::FViewFilterSnapshot::ByViewport); }
 
 	//Adds the given scene to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
-	void FilterByScene(const FSceneInterface* scene, bool isWhitelist = true) { UpdateFilterList(byScene_GT, byScene_RT, scene, true, isWhitelist); }
+	void FilterByScene(const FSceneInterface* scene, bool isWhitelist = true) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByScene, scene, true, isWhitelist); }
 	//Removes the given scene from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
 	//Does nothing if the index isn't in the list.
-	void RemoveByScene(const FSceneInterface* scene) { UpdateFilterList(byScene_GT, byScene_RT, scene, false, false); }
+	void RemoveByScene(const FSceneInterface* scene) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByScene, scene, false, false); }
 	//Sets the viewport filter to be a blacklist or whitelist.
 	//
 	//This can also be done automatically when adding the first element to the filter.
 	//This can't be done after an element has been added.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Viewport")
-	void ConfigureByScene(bool isWhitelist) { ConfigureFilterList(byScene_GT, byScene_RT, isWhitelist); }
+	void ConfigureByScene(bool isWhitelist) { ConfigureFilterList(&EGP::FViewFilterSnapshot::ByScene, isWhitelist); }
 	//Clears all filtering by scene reference, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Viewport")
-	void ClearsByScene() { ClearFilterList(byScene_GT, byScene_RT); }
+	void ClearsByScene() { ClearFilterList(&EGP::FViewFilterSnapshot::ByScene); }
 
 	//Adds the given render-target to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
-	void FilterByRenderTarget(const FRenderTarget* rt, bool isWhitelist = true) { UpdateFilterList(byRenderTarget_GT, byRenderTarget_RT, rt, true, isWhitelist); }
+	void FilterByRenderTarget(const FRenderTarget* rt, bool isWhitelist = true) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByRenderTarget, rt, true, isWhitelist); }
 	//Adds the given render-target to a whitelist or blacklist.
 	//Note that you can't do both whitelisting *and* blacklisting!
 	//
@@ -200,7 +206,7 @@ public:
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
 	//Does nothing if the index isn't in the list.
-	void RemoveByRenderTarget(const FRenderTarget* rt) { UpdateFilterList(byRenderTarget_GT, byRenderTarget_RT, rt, false, false); }
+	void RemoveByRenderTarget(const FRenderTarget* rt) { UpdateFilterList(&EGP::FViewFilterSnapshot::ByRenderTarget, rt, false, false); }
 	//Removes the given scene from the filter list
 	//    (enabling it if using a blacklist, or disabling it if using a whitelist).
 	//
@@ -212,10 +218,10 @@ public:
 	//This can also be done automatically when adding the first element to the filter.
 	//This can't be done after an element has been added.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Render-Target")
-	void ConfigureByRenderTarget(bool isWhitelist) { ConfigureFilterList(byRenderTarget_GT, byRenderTarget_RT, isWhitelist); }
+	void ConfigureByRenderTarget(bool isWhitelist) { ConfigureFilterList(&EGP::FViewFilterSnapshot::ByRenderTarget, isWhitelist); }
 	//Clears all filtering by render-target, including the question of whether it's a whitelist or blacklist.
 	UFUNCTION(BlueprintCallable, Category="Viewport Filtering|Render-Target")
-	void ClearsByRenderTarget() { ClearFilterList(byRenderTarget_GT, byRenderTarget_RT); }
+	void ClearsByRenderTarget() { ClearFilterList(&EGP::FViewFilterSnapshot::ByRenderTarget); }
 
 	
 	bool ShouldRenderFor(const FViewport* viewport) const;
@@ -223,30 +229,76 @@ public:
 	bool ShouldRenderFor(const FSceneViewExtensionContext& sveContext) const;
 	bool ShouldRenderFor(const FSceneViewFamily& viewFamily) const;
 	bool ShouldRenderFor(const FSceneView& view) const;
+
+	//If the filters were edited since the last call, publishes a copy of them for the render thread.
+	//Called once per frame by the subsystem.
+	void PublishChanges_GameThread();
+
+	virtual void BeginDestroy() override;
 	
 protected:
 
-	//Keep a game-thread and render-thread copy of each filter.
-	//This is needed because sometimes decisions (like SVE applicability) are made on the game-thread,
-	//    but most render stuff is done on the render-thread.
-	EGP::FilterList<const FRenderTarget*> byRenderTarget_GT, byRenderTarget_RT;
-	EGP::FilterList<const FSceneInterface*> byScene_GT, byScene_RT;
-	EGP::FilterList<const FViewport*> byViewport_GT, byViewport_RT;
-	EGP::FilterList<TWeakObjectPtr<const AActor>> byViewActor_GT, byViewActor_RT;
-	EGP::FilterList<int> byPlayerIndex_GT, byPlayerIndex_RT;
+	//The game thread edits its own copy of the filters.
+	//Once per frame, if anything changed, it publishes an immutable copy for the render thread
+	//    with a single atomic pointer swap; no render commands are queued per edit.
+	EGP::FViewFilterSnapshot filters_GT;
+	bool filtersChanged_GT = false;
+
+	//The latest snapshot published by the game thread. Owned by this object.
+	//A replaced snapshot is deleted by a render command queued after the swap,
+	//    so any render-thread work that could still be reading it has finished by then.
+	std::atomic<const EGP::FViewFilterSnapshot*> publishedFilters{ nullptr };
+
+	//Gets the filters for the current thread.
+	//On the render thread, each call may return a newer snapshot than the last,
+	//    so load it once per query and pass it along.
+	const EGP::FViewFilterSnapshot& GetFilters() const;
+
+	bool ShouldRenderFor(const EGP::FViewFilterSnapshot& filters, const FSceneViewFamily& viewFamily) const;
+
+	//Render-thread cache of 'ShouldRenderFor(const FSceneViewFamily&)',
+	//    which is asked for every view in the family, by both the scene-view extension and the pass itself.
+	//Keyed on the inputs of the decision rather than the family's address,
+	//    as families rendered in the same frame can reuse each other's memory.
+	struct FFamilyDecision
+	{
+		const FSceneInterface* Scene;
+		const FRenderTarget* RenderTarget;
+		uint32 FrameNumber, FilterVersion;
+		bool Result;
+	};
+	mutable TArray<FFamilyDecision, TInlineAllocator<4>> familyDecisions_RT;
+
+	//Applies an edit to the game-thread filters.
+	//Callable from anywhere; edits from other threads are forwarded to the game thread.
+	template<typename Lambda>
+	void EditFilters(Lambda edit)
+	{
+		if (IsInGameThread())
+		{
+			edit(filters_GT);
+			filtersChanged_GT = true;
+		}
+		else AsyncTask(ENamedThreads::GameThread, [weakThis = TWeakObjectPtr<U_EGP_ViewFilter>(this), edit]()
+		{
+			if (auto* _this = weakThis.Get())
+			{
+				edit(_this->filters_GT);
+				_this->filtersChanged_GT = true;
+			}
+		});
+	}
 
 	//Modifies the given filter list.
 	//Callable from anywhere.
 	template<typename T>
-	void UpdateFilterList(EGP::FilterList<T>& _filter_GT, EGP::FilterList<T>& _filter_RT,
+	void UpdateFilterList(EGP::FilterList<T> EGP::FViewFilterSnapshot::* list,
 						  T element, bool isAdding, bool isAddingAsWhitelist)
 	{
-		//References captured by copy do actually copy the object, so we need pointers. 
-		auto* filterGT = &_filter_GT;
-		auto* filterRT = &_filter_RT;
-
-		auto updateFilter = [element, isAdding, isAddingAsWhitelist](EGP::FilterList<T>& filter)
+		EditFilters([list, element, isAdding, isAddingAsWhitelist](EGP::FViewFilterSnapshot& filters)
 		{
+			auto& filter = filters.*list;
+
 			//You can't add a whitelisted object to a blacklist, and vice versa.
 			if (isAdding && filter.IsAWhitelist().IsSet() && filter.IsAWhitelist() != isAddingAsWhitelist)
 			{
@@ -265,74 +317,23 @@ protected:
 					filter.AddBlacklisted(element);
 				else
 					filter.Remove(element);
-		};
-		
-		ENQUEUE_RENDER_COMMAND(UpdateFilter)([filterRT, updateFilter](FRHICommandListImmediate&)
-		{
-			updateFilter(*filterRT);
-		});
-		
-		if (IsInGameThread())
-		{
-			updateFilter(*filterGT);
-		}
-		else AsyncTask(ENamedThreads::GameThread, [filterGT, updateFilter]()
-		{
-			updateFilter(*filterGT);
 		});
 	}
 	
 	//Clears the given filter list.
 	//Callable from anywhere.
 	template<typename T>
-	void ClearFilterList(EGP::FilterList<T>& _filter_GT, EGP::FilterList<T>& _filter_RT)
+	void ClearFilterList(EGP::FilterList<T> EGP::FViewFilterSnapshot::* list)
 	{
-		//References captured by copy do actually copy the object, so we need pointers. 
-		auto* filterGT = &_filter_GT;
-		auto* filterRT = &_filter_RT;
-
-		auto updateFilter = [](EGP::FilterList<T>& filter) { filter.Clear(); };
-
-		ENQUEUE_RENDER_COMMAND(ClearFilter)([filterRT, updateFilter](FRHICommandListImmediate&)
-		{
-			updateFilter(*filterRT);
-		});
-
-		if (IsInGameThread())
-		{
-			updateFilter(*filterGT);
-		}
-		else AsyncTask(ENamedThreads::GameThread, [filterGT, updateFilter]()
-		{
-			updateFilter(*filterGT);
-		});
+		EditFilters([list](EGP::FViewFilterSnapshot& filters) { (filters.*list).Clear(); });
 	}
 	
 	//Configures the given filter list.
 	//Callable from anywhere.
 	template<typename T>
-	void ConfigureFilterList(EGP::FilterList<T>& _filter_GT, EGP::FilterList<T>& _filter_RT,
-				   		     bool makeWhitelist)
+	void ConfigureFilterList(EGP::FilterList<T> EGP::FViewFilterSnapshot::* list, bool makeWhitelist)
 	{
-		//References captured by copy do actually copy the object, so we need pointers. 
-		auto* filterGT = &_filter_GT;
-		auto* filterRT = &_filter_RT;
-
-		auto updateFilter = [makeWhitelist](EGP::FilterList<T>& filter) { filter.Configure(makeWhitelist); };
-
-		ENQUEUE_RENDER_COMMAND(ClearFilter)([filterRT, updateFilter](FRHICommandListImmediate&)
-		{
-			updateFilter(*filterRT);
-		});
-
-		if (IsInGameThread())
-		{
-			updateFilter(*filterGT);
-		}
-		else AsyncTask(ENamedThreads::GameThread, [filterGT, updateFilter]()
-		{
-			updateFilter(*filterGT);
-		});
+		EditFilters([list, makeWhitelist](EGP::FViewFilterSnapshot& filters) { (filters.*list).Configure(makeWhitelist); });
 	}
 };
 
@@ -342,23 +343,10 @@ protected:
 
 namespace EGP { namespace CustomRenderPasses
 {
-	//We don't know what kind of proxy data each render pass uses, and templates don't play well with Unreal,
-	//    so we allocate a constant number of bytes per proxy
-	//    and let the user worry about pooling heap memory if they truly need more than that.
-	//
-	//You can also `#define EGP_CUSTOMRENDERPASS_MAXPROXYBYTESIZE 1024` or whatever size you want,
-	//    but this forces all custom passes in the project to use the same size.
-	static constexpr uint32 MaxInlineProxyByteSize =
-		#if defined(EGP_CUSTOMRENDERPASS_MAXPROXYBYTESIZE)
-			EGP_CUSTOMRENDERPASS_MAXPROXYBYTESIZE
-		#else
-			512
-		#endif
-	;
-
-	//A byte array holding a render proxy, which can stay on the stack as long as it is less than N bytes.
-	//Otherwise it will be moved to the heap.
-	using ProxyData_t = TArray<std::byte, TInlineAllocator<MaxInlineProxyByteSize>>;
+	//Proxies travel from the game thread to the render thread as raw bytes,
+	//    so their alignment can't be more than this.
+	static constexpr int32 MaxProxyAlignment = 16;
+	using AlignedBytes_t = TArray<std::byte, TAlignedHeapAllocator<MaxProxyAlignment>>;
 } }
 
 #pragma region Component
@@ -378,9 +366,18 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="Custom Render Pass")
 	bool EnabledInCustomPass = true;
 
+	//If true, this component doesn't tick.
+	//Instead its pass updates it along with every other such component, in one batch per frame.
+	//This saves a lot of tick-manager overhead when there are thousands of components.
+	//Child classes that default this to true should also clear 'PrimaryComponentTick.bCanEverTick' in their constructor,
+	//    so their tick functions are never registered in the first place.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Custom Render Pass")
+	bool UpdateFromSubsystem = false;
+
 
 	U_EGP_RenderPassComponent();
 	
+	virtual void OnRegister() override;
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type reason) override;
 	virtual void TickComponent(float deltaSeconds, ELevelTick tickType, FActorComponentTickFunction* thisTickFn) override;
@@ -388,70 +385,251 @@ public:
 	//Reports the kind of render pass this component is meant to be a part of.
 	virtual TSubclassOf<U_EGP_RenderPass> GetPassType() const
 		PURE_VIRTUAL(UCustomRenderPassComponent::GetPassType, return nullptr; )
-	//Converts this component's data into a POD struct for the render-thread, constructing it in the given byte buffer.
-	//You can usually implement this by just calling through to 'ImplConstructProxyData_GameThread()'.
-	virtual void ConstructProxyData_GameThread(EGP::CustomRenderPasses::ProxyData_t& output) const
+	//The size of the struct representing this component on the render thread.
+	//It must be the 'PrimitiveProxyType' of the pass's scene-view extension.
+	//
+	//You can usually implement the proxy functions with 'EGP_PASS_COMPONENT_SIMPLE_PROXY_IMPL()'.
+	virtual int32 GetProxySize() const
+		PURE_VIRTUAL(UCustomRenderPassComponent::GetProxySize, return 0; )
+	//Converts this component's data into a POD struct for the render-thread, constructing it in the given memory.
+	virtual void ConstructProxyData_GameThread(void* output) const
 		PURE_VIRTUAL(UCustomRenderPassComponent::ConstructProxyData_GameThread, )
-	//Destroys the POD struct representing this component.
-	//You must implement this by calling through to 'ImplDestructProxyData_GameThread()'.
-	virtual void DestructProxyData_GameThread() const
+	//Destroys a struct made by 'ConstructProxyData_GameThread()', if it didn't need to be sent to the render thread.
+	virtual void DestructProxyData_GameThread(void* proxy) const
 		PURE_VIRTUAL(UCustomRenderPassComponent::DestructProxyData_GameThread, )
+	//If true, 'ConstructProxyData_GameThread()' only reads from this component,
+	//    so components updated by the subsystem can build their proxies in parallel.
+	virtual bool IsProxyConstructionThreadSafe() const { return false; }
 
-	//Grabs the most recent version of the render-thread data struct representing this component.
-	template<typename POD>
-	const POD& GetProxy_RenderThread() const { return reinterpret_cast<const POD&>(GetProxy_RenderThread()); }
-	const EGP::CustomRenderPasses::ProxyData_t& GetProxy_RenderThread() const { check(IsInRenderingThread()); return *renderThreadProxy.Get(); }
-
-	UPrimitiveComponent* GetTarget_RenderThread() const { check(IsInRenderingThread()); return renderThreadTarget.Get(); }
-
-protected:
-
-	//Implements the most common behavior for `CreateProxyData_RenderThread()`.
-	template<typename POD>
-	static void ImplConstructProxyData_GameThread(EGP::CustomRenderPasses::ProxyData_t& output, POD&& proxyData)
-	{
-		output.SetNumUninitialized(sizeof(POD));
-		auto* proxyOutput = reinterpret_cast<POD*>(output.GetData());
-
-		new (proxyOutput) POD(proxyData);
-	}
-	//Implements the most common behavior for `DestructProxyData_RenderThread()`.
-	template<typename POD>
-	void ImplDestructProxyData_GameThread() const
-	{
-		auto proxySharedPtr = renderThreadProxy;
-		ENQUEUE_RENDER_COMMAND(DestructCustomRenderPassComponentProxy)([proxySharedPtr](FRHICommandListImmediate&)
-		{
-			//If the proxy was never created, there's nothing to do.
-			if (proxySharedPtr->Num() == 0)
-				return;
-			
-			check(proxySharedPtr->Num() == sizeof(POD));
-			auto* proxy = reinterpret_cast<POD*>(proxySharedPtr->GetData());
-			
-			proxy->~POD();
-		});
-	}
+	//The proxy is only sent to the render thread when its bytes (or the attach parent) change.
+	//If your proxy points at some other data which changed in-place, call this to force it to be re-sent next tick.
+	UFUNCTION(BlueprintCallable, Category="Custom Render Pass")
+	void MarkProxyDirty() { isProxyDirty = true; }
 
 private:
 
-	TSharedPtr<EGP::CustomRenderPasses::ProxyData_t, ESPMode::ThreadSafe> renderThreadProxy;
-	TWeakObjectPtr<UPrimitiveComponent> renderThreadTarget;
+	UPROPERTY(Transient)
+	U_EGP_RenderPass* registeredPass = nullptr;
+	//This component's slot in the pass's render-thread proxy storage, assigned at registration.
+	int32 proxyHandle = INDEX_NONE;
+	//This component's index in the pass's list of subsystem-updated components, if it's in that list.
+	int32 batchedUpdateIndex = INDEX_NONE;
+	friend U_EGP_RenderPass;
+
+	//Builds this frame's proxy into 'newProxy_GameThread', returning whether it needs to be sent.
+	//If not, the new proxy is already destroyed.
+	bool BuildProxy_GameThread();
+	//Sends the proxy made by 'BuildProxy_GameThread()' to the pass.
+	void SendBuiltProxy_GameThread();
+
+	//The last data sent to the render thread, to skip sending it again when nothing changed.
+	//Only its bytes are ever looked at.
+	EGP::CustomRenderPasses::AlignedBytes_t lastSentProxy_GameThread;
+	//Where each tick's proxy is built before being compared and sent.
+	EGP::CustomRenderPasses::AlignedBytes_t newProxy_GameThread;
+	TWeakObjectPtr<UPrimitiveComponent> lastSentTarget_GameThread;
+	FBoxSphereBounds lastSentTargetBounds_GameThread;
+	//The target's scene proxy when it was last sent; a new one means the target was (re-)added to the scene,
+	//    and the render thread has to look for it again.
+	const FPrimitiveSceneProxy* lastSentTargetProxy_GameThread = nullptr;
+	//The target found by 'BuildProxy_GameThread()'.
+	UPrimitiveComponent* newTarget_GameThread = nullptr;
+	bool isProxyDirty = true;
+	//Set by 'BuildProxy_GameThread()' during batched updates.
+	bool hasBuiltProxy = false;
 };
 
 //If your render pass component can set up its POD proxy by simply calling its constructor,
 //    then you can use this macro to implement the component's proxy virtual functions.
 #define EGP_PASS_COMPONENT_SIMPLE_PROXY_IMPL(TProxy, createExpr) \
-	virtual void ConstructProxyData_GameThread(EGP::CustomRenderPasses::ProxyData_t& output) const override { \
-		TProxy localProxyInstance = (createExpr); \
-		ImplConstructProxyData_GameThread<TProxy>(output, MoveTemp(localProxyInstance)); \
+	static_assert(alignof(TProxy) <= EGP::CustomRenderPasses::MaxProxyAlignment, \
+				  "Render-pass proxy structs can't be over-aligned"); \
+	virtual int32 GetProxySize() const override { return sizeof(TProxy); } \
+	virtual void ConstructProxyData_GameThread(void* output) const override { \
+		new (output) TProxy(createExpr); \
 	} \
-	virtual void DestructProxyData_GameThread() const override { \
-		ImplDestructProxyData_GameThread<TProxy>(); \
+	virtual void DestructProxyData_GameThread(void* proxy) const override { \
+		static_cast<TProxy*>(proxy)->~TProxy(); \
 	}
 
 #pragma endregion
 
+#pragma region Proxy transfer
+
+namespace EGP { namespace CustomRenderPasses
+{
+	//Every change the game thread made to a pass's component proxies over one frame.
+	//The game thread fills one in, hands it to the render thread with the pass's per-frame render command,
+	//    and the render thread gives it back once it's applied.
+	//Mailboxes are pooled, so their arrays keep their capacity and no allocation happens per component.
+	struct FProxyMailbox
+	{
+		struct FEntry
+		{
+			int32 Handle = INDEX_NONE;
+
+			//If true, this entry removes the component's proxy.
+			//Otherwise this entry adds or updates the proxy.
+			bool IsRemoval = false;
+
+			//For updates: the scene ID and bounds of the primitive the component is attached to,
+			//    and the location of the new proxy within 'Bytes'.
+			FPrimitiveComponentId TargetID;
+			FBoxSphereBounds TargetBounds;
+			int32 ByteOffset = 0;
+			//The size the component reported for its proxy, checked against the pass's proxy type.
+			int32 ByteSize = 0;
+		};
+		//Entries are applied in order.
+		TArray<FEntry> Entries;
+		//The proxies of every update, constructed in-place and packed contiguously.
+		//They are moved out (and destroyed) by the render thread.
+		AlignedBytes_t Bytes;
+
+		void Reset()
+		{
+			Entries.Reset();
+			Bytes.Reset();
+		}
+	};
+
+	//The render thread's copy of every component in a pass.
+	//Stored densely as a structure-of-arrays, so that iterating over it is a linear scan;
+	//    each component is addressed by the stable handle it was given when registering,
+	//    and removals swap the last element into the hole.
+	//
+	//Nothing here points back at game-thread objects.
+	//Each component's target primitive is found in the render scene by its ID,
+	//    and the result is cached until the scene re-creates or removes that primitive.
+	//The targets' bounds are also kept in an octree, so passes can skip components outside the view.
+	//
+	//The proxies themselves live in the typed child class, 'TComponentProxyStorage<>'.
+	struct EXTENDEDGRAPHICSPROGRAMMING_API FComponentProxyStorage
+	{
+		TArray<FPrimitiveComponentId> TargetIDs;
+
+		int32 Num() const { return TargetIDs.Num(); }
+
+		//Moves the proxy constructed at the given memory into this storage, adding a new element if needed.
+		//The proxy at the given memory is destroyed afterwards.
+		//Its size must match this storage's proxy type; a mismatch means a component and its pass disagree.
+		void Update(int32 handle, FPrimitiveComponentId targetID, const FBoxSphereBounds& targetBounds,
+					void* movedProxy, int32 movedProxySize);
+		//Removes the element for the given handle, if it exists.
+		void Remove(int32 handle);
+
+		//Gets the render proxy of the given element's target primitive, or null if it isn't in the scene.
+		//Cached primitives are checked by their persistent index, which is cheap.
+		//A real search only happens for a few frames after something changes:
+		//    the element is updated (which the game thread does whenever its target is added to the scene again),
+		//    or its cached primitive is gone from its index.
+		const FPrimitiveSceneProxy* ResolvePrimitive_RenderThread(const FScene& scene, int32 denseIdx);
+
+		//Finds the elements whose target bounds touch the given frustum.
+		//The bounds are the ones the game thread last sent, so they're at most a frame old.
+		template<typename Allocator>
+		void FindInFrustum(const FConvexVolume& frustum, TArray<int32, Allocator>& outDenseIndices) const
+		{
+			boundsOctree.FindNodesWithPredicate(
+				[&](FOctreeNodeIndex, FOctreeNodeIndex, const FBoxCenterAndExtent& nodeBounds)
+				{
+					return frustum.IntersectBox(FVector{ nodeBounds.Center }, FVector{ nodeBounds.Extent });
+				},
+				[&](FOctreeNodeIndex, FOctreeNodeIndex node, const FBoxCenterAndExtent&)
+				{
+					for (const auto& element : boundsOctree.GetElementsForNode(node))
+						if (frustum.IntersectBox(FVector{ element.Bounds.Center }, FVector{ element.Bounds.Extent }))
+							outDenseIndices.Add(denseIndexByHandle[element.Handle]);
+				}
+			);
+		}
+
+		virtual ~FComponentProxyStorage() { }
+
+	protected:
+		virtual int32 GetProxySize() const = 0;
+		virtual void AddProxy(void* movedProxy) = 0;
+		virtual void AssignProxy(int32 denseIdx, void* movedProxy) = 0;
+		virtual void RemoveProxyAtSwap(int32 denseIdx) = 0;
+
+	private:
+		TArray<int32> denseIndexByHandle, handleByDenseIndex;
+
+		//Where each target was last found in the scene.
+		struct FTargetCache
+		{
+			//A new primitive can take a frame to show up in the scene after the game thread sends it,
+			//    so a missing target is searched for on this many frames before giving up.
+			static constexpr uint8 NumSearchFrames = 2;
+
+			//The target's persistent index in the scene, or INDEX_NONE if unknown.
+			int32 SceneIndex = INDEX_NONE;
+			//How many more frames the target can be searched for.
+			//Re-armed by 'Update()' and by the cached primitive going away; otherwise a missing target costs nothing.
+			uint8 SearchesLeft = NumSearchFrames;
+			//The render-thread frame of the last search that didn't find the target.
+			uint64 MissFrame = MAX_uint64;
+		};
+		//Parallel to 'TargetIDs'.
+		TArray<FTargetCache> targetCaches;
+
+		//Finds primitives in the scene by ID.
+		//Rebuilt at most once per frame, and only on frames where some element is searching for its target.
+		TMap<FPrimitiveComponentId, int32> sceneIndexByID;
+		uint64 sceneIndexByIDFrame = MAX_uint64;
+
+		//A loose octree of every element's target bounds, for frustum queries.
+		struct FOctreeElement
+		{
+			int32 Handle;
+			FBoxCenterAndExtent Bounds;
+			FComponentProxyStorage* Owner;
+		};
+		struct FOctreeSemantics
+		{
+			enum { MaxElementsPerLeaf = 16 };
+			enum { MinInclusiveElementsPerNode = 7 };
+			enum { MaxNodeDepth = 12 };
+			using ElementAllocator = TInlineAllocator<MaxElementsPerLeaf>;
+
+			static const FBoxCenterAndExtent& GetBoundingBox(const FOctreeElement& e) { return e.Bounds; }
+			static bool AreElementsEqual(const FOctreeElement& a, const FOctreeElement& b) { return a.Handle == b.Handle; }
+			static void SetElementId(const FOctreeElement& e, FOctreeElementId2 id) { e.Owner->octreeIDByHandle[e.Handle] = id; }
+			static void ApplyOffset(FOctreeElement& e, const FVector& offset) { e.Bounds.Center += FVector4{ offset, 0 }; }
+		};
+		TOctree2<FOctreeElement, FOctreeSemantics> boundsOctree{ FVector::ZeroVector, HALF_WORLD_MAX };
+		TArray<FOctreeElementId2> octreeIDByHandle;
+	};
+
+	template<typename TProxy>
+	struct TComponentProxyStorage final : public FComponentProxyStorage
+	{
+		//Parallel to 'TargetIDs'.
+		TArray<TProxy> Proxies;
+
+	protected:
+		virtual int32 GetProxySize() const override { return sizeof(TProxy); }
+		virtual void AddProxy(void* movedProxy) override
+		{
+			auto& proxy = *static_cast<TProxy*>(movedProxy);
+			Proxies.Add(MoveTemp(proxy));
+			proxy.~TProxy();
+		}
+		virtual void AssignProxy(int32 denseIdx, void* movedProxy) override
+		{
+			auto& proxy = *static_cast<TProxy*>(movedProxy);
+			Proxies[denseIdx] = MoveTemp(proxy);
+			proxy.~TProxy();
+		}
+		virtual void RemoveProxyAtSwap(int32 denseIdx) override
+		{
+			Proxies.RemoveAtSwap(denseIdx, EAllowShrinking::No);
+		}
+	};
+} }
+
+#pragma endregion
+
 #pragma region Subsystem
 
 //Manages all custom render passes.
@@ -581,13 +759,18 @@ public:
 				return false;
 		};
 		IsActiveThisFrameFunctions.Add(testFilter);
+
+		//Store the pass's component proxies with their real type.
+		if constexpr (!std::is_same_v<ComponentType, void>)
+			pass->ComponentProxies_RenderThread = MakeUnique<EGP::CustomRenderPasses::TComponentProxyStorage<PrimitiveProxyType>>();
 	}
 
 	//Iterates over each renderable object for this custom pass and executes your lambda on it.
+	//Only render-thread data is touched; the game-thread components are never dereferenced.
 	//The lambda's signature is:
-	//  `(const ComponentType&, const PrimitiveProxyType&,   const UPrimitiveComponent&, const FPrimitiveSceneProxy&) -> void`
+	//  `(const PrimitiveProxyType&, const FPrimitiveSceneProxy&) -> void`
 	template<typename Lambda>
-	void ForEachComponent_RenderThread(Lambda toDo)
+	void ForEachComponent_RenderThread(const FScene& scene, Lambda toDo)
 	{
 		check(IsInRenderingThread());
 		if constexpr (std::is_same_v<ComponentType, void>)
@@ -597,33 +780,43 @@ public:
 		}
 		else
 		{
-			for (const auto& [_component, proxyBytes] : Pass->GetComponentData_RenderThread())
-			{
-				//I'm not 100% sure how safe it is to use 'IsValid()' in this thread.
-				if (!_component.IsValid())
-					continue;
-
-				//Ideally I'd expect the user's custom pass
-				//    to grab its own pointer to each primitive component's render-proxy as desired
-				//    and store it in the custom pass component's proxy struct, on 'WriteProxyData_RenderThread()'.
-				//However in my experience that seems doomed to crash, and I can't for the life of me
-				//    see any function or engine code sample to know when a proxy stored that way
-				//    has been destroyed and recreated while I wasn't looking.
-				//So instead I grab the render proxy on demand, directly from the primitive-component.
-				//Primitive scene proxies are only changed on the render-thread so we should be safe from race conditions.
-				auto* primitiveComponent = _component->GetTarget_RenderThread();
-				
-				if (primitiveComponent == nullptr || primitiveComponent->SceneProxy == nullptr)
-					return;
-
-				//Not sure if it's safe to use CastChecked on this thread, so just do a raw reinterpret_cast.
-				auto* component = reinterpret_cast<const ComponentType*>(_component.Get());
-				const auto& proxy = reinterpret_cast<const PrimitiveProxyType&>(proxyBytes);
-				const auto* primitiveProxy = primitiveComponent->SceneProxy;
-
-				toDo(*component, proxy,    *primitiveComponent, *primitiveProxy);
-			}
+			auto& storage = GetProxyStorage_RenderThread();
+			for (int32 i = 0; i < storage.Num(); ++i)
+				if (const auto* primitiveProxy = storage.ResolvePrimitive_RenderThread(scene, i))
+					toDo(storage.Proxies[i], *primitiveProxy);
+		}
+	}
+	//Like 'ForEachComponent_RenderThread()', but only visits the components whose bounds touch the view frustum.
+	//The search uses an octree, so the cost depends on the number of nearby components rather than the total.
+	template<typename Lambda>
+	void ForEachVisibleComponent_RenderThread(const FScene& scene, const FSceneView& view, Lambda toDo)
+	{
+		check(IsInRenderingThread());
+		if constexpr (std::is_same_v<ComponentType, void>)
+		{
+			checkf(false, TEXT("You called 'ForEachVisibleComponent_RenderThread(), in a scene-view extension "
+							     "that doesn't use components!"));
 		}
+		else
+		{
+			auto& storage = GetProxyStorage_RenderThread();
+
+			TArray<int32, SceneRenderingAllocator> visibleIndices;
+			storage.FindInFrustum(view.ViewFrustum, visibleIndices);
+
+			for (int32 i : visibleIndices)
+				if (const auto* primitiveProxy = storage.ResolvePrimitive_RenderThread(scene, i))
+					toDo(storage.Proxies[i], *primitiveProxy);
+		}
+	}
+
+private:
+
+	auto& GetProxyStorage_RenderThread()
+	{
+		return static_cast<EGP::CustomRenderPasses::TComponentProxyStorage<PrimitiveProxyType>&>(
+			Pass->GetComponentData_RenderThread()
+		);
 	}
 };
 
@@ -644,6 +837,30 @@ struct F_EGP_ViewPersistentData
 						  const FInt32Point& newResolution,
 						  const FInt32Point& oldToNewPixelOffset) = 0;
 
+	//Estimates the GPU memory owned by this data, for the memory budget of its T_EGP_PerViewData.
+	virtual uint64 GetGPUMemoryBytes() const { return 0; }
+
+	//Optional hooks for "parking" the data of a view that stopped rendering:
+	//    moving its state into system memory and releasing its GPU resources,
+	//    so it can be restored later without keeping VRAM committed in the meantime.
+	//By default, data doesn't support parking and is simply cleaned up.
+
+	//Starts reading this data back from the GPU. Returns false if parking isn't supported.
+	virtual bool BeginParking(FRDGBuilder&) { return false; }
+	//Called every frame once parking has begun.
+	//When the readback (and any other processing of it) is done,
+	//    this should store the state and release the GPU resources, then return true.
+	virtual bool TryFinishParking() { return false; }
+	//Called if the view comes back before parking finished.
+	//The GPU resources should still be intact at this point.
+	virtual void CancelParking() { }
+	//Re-creates the GPU resources from the parked state, at their old resolution.
+	//This runs while the view is being rendered, so it shouldn't wait on anything.
+	//If the view's resolution changed since then, Resample() is called afterwards.
+	virtual void Unpark(FRDGBuilder&, const FViewInfo&) { }
+	//Gets the system memory owned by this data while it's parked.
+	virtual uint64 GetParkedBytes() const { return 0; }
+
 	
 	//Automatic copies are considered an error.
 	F_EGP_ViewPersistentData(const F_EGP_ViewPersistentData&) = delete;
@@ -656,6 +873,20 @@ struct F_EGP_ViewPersistentData
 };
 
 
+namespace EGP
+{
+	//The GPU memory that each T_EGP_PerViewData may use if it doesn't set its own budget,
+	//    from the cvar 'r.EGP.PerViewData.BudgetMB'. 0 means no limit.
+	EXTENDEDGRAPHICSPROGRAMMING_API uint64 GetDefaultPerViewDataBudgetBytes();
+
+	//Whether the view is a player's view of the game, as opposed to a scene capture, reflection, editor viewport, etc.
+	inline bool IsPrimaryView(const FSceneView& view)
+	{
+		return view.bIsGameView && !view.bIsSceneCapture &&
+			   !view.bIsReflectionCapture && !view.bIsPlanarReflection;
+	}
+}
+
 //Non-templated base class of T_EGP_PerViewData, to expose some of its more general behavior.
 struct F_EGP_PerViewData
 {
@@ -679,33 +910,134 @@ struct T_EGP_PerViewData final : public F_EGP_PerViewData
 	int CleanupFrameThreshold = 60;
 	//If a view's ID is in this set, it is never eligible for being cleaned up.
 	TSet<int> CleanupPreventionByViewID;
+
+	//If a view goes this many frames without its data being accessed, and the data supports parking,
+	//    it is parked in system memory instead (see 'F_EGP_ViewPersistentData::BeginParking()').
+	//Should be smaller than 'CleanupFrameThreshold'. If 0, data is never parked.
+	int ParkFrameThreshold = 0;
+	//Parked data is cleaned up after this many frames without being accessed.
+	int ParkedCleanupFrameThreshold = 60 * 60 * 5;
+
+	//When the views' data adds up to more GPU memory than this, the least important views are cleaned up.
+	//Views of the main game viewport are the most important, followed by the most recently used.
+	//Views drawn in the last frame are never cleaned up for the budget, as they'd only be re-created.
+	//If 0, 'EGP::GetDefaultPerViewDataBudgetBytes()' is used instead.
+	uint64 MemoryBudgetBytes = 0;
 	
 	//Should be called once per frame on the render thread.
-	//Cleans up view data that hasn't been used in a while.
+	//Parks or cleans up view data that hasn't been used in a while,
+	//    and cleans up view data that doesn't fit in the memory budget.
 	virtual void Tick() override final 
 	{
 		check(IsInRenderingThread());
 
 		viewIDBuffer.Empty();
 		dataByViewID.GetKeys(viewIDBuffer);
+		uint64 totalBytes = 0;
+		//Readbacks for parking are all queued into one graph, created only if needed.
+		TOptional<FRDGBuilder> parkingGraph;
 		for (int viewID : viewIDBuffer)
 		{
+			auto& data = *dataByViewID[viewID];
+			
 			//Don't advance the timestamp at all for views that are permanent.
 			if (CleanupPreventionByViewID.Contains(viewID))
+			{
+				totalBytes += data.User.GetGPUMemoryBytes();
 				continue;
-			
-			auto& data = dataByViewID[viewID];
-			if (data.FramesSinceAccess > CleanupFrameThreshold)
+			}
+
+			const int cleanupThreshold = (data.ParkState == EParkState::Resident) ?
+											 CleanupFrameThreshold :
+											 ParkedCleanupFrameThreshold;
+			if (data.FramesSinceAccess > cleanupThreshold)
+			{
 				dataByViewID.Remove(viewID);
-			else
-				data.FramesSinceAccess += 1;
+				continue;
+			}
+			data.FramesSinceAccess += 1;
+
+			//Move idle views into system memory.
+			if (data.ParkState == EParkState::Resident && data.CanPark &&
+				ParkFrameThreshold > 0 && data.FramesSinceAccess > ParkFrameThreshold)
+			{
+				if (!parkingGraph.IsSet())
+					parkingGraph.Emplace(FRHICommandListImmediate::Get(), RDG_EVENT_NAME("EGP_ParkViewData"));
+				if (data.User.BeginParking(parkingGraph.GetValue()))
+					data.ParkState = EParkState::Parking;
+				else
+					data.CanPark = false;
+			}
+			else if (data.ParkState == EParkState::Parking && data.User.TryFinishParking())
+			{
+				data.ParkState = EParkState::Parked;
+				UE_LOG(LogEGP, Verbose,
+					   TEXT("Parked view %i's data in system memory (%llu bytes)"),
+					   viewID, data.User.GetParkedBytes());
+			}
+
+			totalBytes += data.User.GetGPUMemoryBytes();
+		}
+		//Submit the readbacks before any view that started parking can be evicted below.
+		if (parkingGraph.IsSet())
+			parkingGraph->Execute();
+
+		//If over budget, evict views until we aren't.
+		const uint64 budget = (MemoryBudgetBytes > 0) ? MemoryBudgetBytes : EGP::GetDefaultPerViewDataBudgetBytes();
+		if (budget == 0 || totalBytes <= budget)
+		{
+			hasWarnedOverBudget = false;
+			return;
+		}
+
+		//A view that was just drawn would only be re-created next frame, so leave it alone.
+		//A view that's still parking frees its GPU memory once parking finishes,
+		//    and evicting it now would throw away the state it's being parked to keep.
+		viewIDBuffer.RemoveAll([&](int viewID)
+		{
+			const auto& data = *dataByViewID[viewID];
+			return CleanupPreventionByViewID.Contains(viewID) ||
+				   data.ParkState != EParkState::Resident ||
+				   data.FramesSinceAccess <= 1;
+		});
+		//Put the least important views first.
+		viewIDBuffer.Sort([&](int a, int b)
+		{
+			const auto &dataA = *dataByViewID[a],
+					   &dataB = *dataByViewID[b];
+			if (dataA.IsPrimaryView != dataB.IsPrimaryView)
+				return !dataA.IsPrimaryView;
+			return dataA.FramesSinceAccess > dataB.FramesSinceAccess;
+		});
+		for (int viewID : viewIDBuffer)
+		{
+			if (totalBytes <= budget)
+				break;
+
+			const uint64 viewBytes = dataByViewID[viewID]->User.GetGPUMemoryBytes();
+			UE_LOG(LogEGP, Verbose,
+				   TEXT("Per-view data is over its memory budget (%llu / %llu bytes); evicting view %i (%llu bytes)"),
+				   totalBytes, budget, viewID, viewBytes);
+			totalBytes -= FMath::Min(totalBytes, viewBytes);
+			dataByViewID.Remove(viewID);
+		}
+
+		//Everything left is in use (or permanent), so the budget is simply too small for this many views.
+		//Warn once each time this starts happening, rather than every frame.
+		if (totalBytes > budget && !hasWarnedOverBudget)
+		{
+			UE_LOG(LogEGP, Warning,
+				   TEXT("Per-view data can't fit in its memory budget (%llu / %llu bytes): every remaining view is in use. ")
+					   TEXT("Raise the budget ('r.EGP.PerViewData.BudgetMB') or render fewer views"),
+				   totalBytes, budget);
 		}
+		hasWarnedOverBudget = (totalBytes > budget);
 	}
 
 	//Gets the data for the given view, creating new data if none is registered.
 	//When new data is created, the extra arguments you pass are forwarded to your data's constructor.
 	//
-	//The returned reference is invalidated as soon as you call Tick() or create data for a new view.
+	//The returned reference is invalidated when you call Tick(), if that view's data is cleaned up.
 	template<typename... NewDataArgs>
 	TData& DataForView(FRDGBuilder& graph, const FViewInfo& view,
 					   NewDataArgs&&... constructorArgs)
@@ -715,20 +1047,38 @@ struct T_EGP_PerViewData final : public F_EGP_PerViewData
 		int viewID = view.State->GetViewKey();
 
 		//Get or create the asset.
-		auto* data = dataByViewID.Find(viewID);
-		if (data == nullptr)
+		//Each view's data is in its own allocation, so it never moves when other views come and go.
+		auto* found = dataByViewID.Find(viewID);
+		ViewData* data;
+		if (found != nullptr)
+		{
+			data = found->Get();
+		}
+		else
 		{
-			data = &dataByViewID.Emplace(viewID, ViewData{
+			data = dataByViewID.Emplace(viewID, MakeUnique<ViewData>(
 				TData{ graph, view, view.ViewRect,
 						    Forward<NewDataArgs>(constructorArgs)... },
 				view.ViewRect,
-				view.GetFeatureLevel(),
-				0
-			});
+				view.GetFeatureLevel()
+			)).Get();
 		}
 
+		//Bring the data back from system memory if it was parked.
+		if (data->ParkState == EParkState::Parking)
+		{
+			data->User.CancelParking();
+		}
+		else if (data->ParkState == EParkState::Parked)
+		{
+			UE_LOG(LogEGP, Verbose, TEXT("Unparking view %i's data"), viewID);
+			data->User.Unpark(graph, view);
+		}
+		data->ParkState = EParkState::Resident;
+
 		//Update the timestamp.
 		data->FramesSinceAccess = 0;
+		data->IsPrimaryView = EGP::IsPrimaryView(view);
 
 		//Resample the asset if needed.
 		if (data->PixelSubset != view.ViewRect)
@@ -748,24 +1098,45 @@ struct T_EGP_PerViewData final : public F_EGP_PerViewData
 		return dataByViewID.Contains(view.State->GetViewKey());
 	}
 
-	//Allows you to access each active per-view data instance.
+	//Adds up the estimated system memory of every view's parked data.
+	uint64 GetParkedBytes() const
+	{
+		uint64 total = 0;
+		for (const auto& [id, data] : dataByViewID)
+			if (data->ParkState == EParkState::Parked)
+				total += data->User.GetParkedBytes();
+		return total;
+	}
+
+	//Adds up the estimated GPU memory of every view's data.
+	uint64 GetGPUMemoryBytes() const
+	{
+		uint64 total = 0;
+		for (const auto& [id, data] : dataByViewID)
+			total += data->User.GetGPUMemoryBytes();
+		return total;
+	}
+
+	//Allows you to access each per-view data instance, including parked ones.
 	//The lambda signature should be '(int viewID, TData& data, ERHIFeatureLevel::Type featureLevel) -> void'.
 	template<typename Lambda>
 	void ForEachView(Lambda toDo)
 	{
 		for (auto& [id, data] : dataByViewID)
-			toDo(int{ id }, data.User, ERHIFeatureLevel::Type{ data.FeatureLevel });
+			toDo(int{ id }, data->User, ERHIFeatureLevel::Type{ data->FeatureLevel });
 	}
-	//Allows you to access each active per-view data instance.
+	//Allows you to access each per-view data instance, including parked ones.
 	//The lambda signature should be '(int viewID, const TData& data, ERHIFeatureLevel::Type featureLevel) -> void'.
 	template<typename Lambda>
 	void ForEachView(Lambda toDo) const
 	{
 		for (const auto& [id, data] : dataByViewID)
-			toDo(id, data.User, data.FeatureLevel);
+			toDo(id, data->User, data->FeatureLevel);
 	}
 	
 private:
+
+	enum class EParkState : uint8 { Resident, Parking, Parked };
 	
 	struct ViewData
 	{
@@ -773,11 +1144,20 @@ private:
 		FIntRect PixelSubset;
 		ERHIFeatureLevel::Type FeatureLevel;
 		int FramesSinceAccess = 0;
+		//Whether this is a player's view of the game, as opposed to a scene capture, reflection, etc.
+		bool IsPrimaryView = false;
+		EParkState ParkState = EParkState::Resident;
+		//Set to false once the data turns out to not support parking.
+		bool CanPark = true;
+
+		ViewData(TData&& user, const FIntRect& pixelSubset, ERHIFeatureLevel::Type featureLevel)
+			: User(MoveTemp(user)), PixelSubset(pixelSubset), FeatureLevel(featureLevel) { }
 	};
-	TMap<int, ViewData> dataByViewID;
+	TMap<int, TUniquePtr<ViewData>> dataByViewID;
 
 	//Used inside Tick()
 	TArray<int> viewIDBuffer;
+	bool hasWarnedOverBudget = false;
 };
 
 #pragma endregion
@@ -797,7 +1177,12 @@ public:
 	virtual void Tick_GameThread(UWorld& thisWorld, float deltaSeconds);
 	virtual void Tick_RenderThread(const FSceneInterface& thisScene, float gameThreadDeltaSeconds);
 
-	const auto& GetComponentData_RenderThread() const { check(IsInRenderingThread()); return ComponentProxies_RenderThread; }
+	EGP::CustomRenderPasses::FComponentProxyStorage& GetComponentData_RenderThread() const
+	{
+		check(IsInRenderingThread());
+		check(ComponentProxies_RenderThread.IsValid());
+		return *ComponentProxies_RenderThread;
+	}
 
 	//The filter settings, controlling which views use this render pass.
 	UPROPERTY(BlueprintReadOnly, VisibleInstanceOnly, Transient)
@@ -809,6 +1194,9 @@ protected:
 	//The subsystem and component both manage this render pass's internal logic.
 	friend U_EGP_RenderPassComponent;
 	friend U_EGP_RenderPassSubsystem;
+	//The scene-view extension knows the proxy type, so it creates the proxy storage.
+	template<typename, typename, typename>
+	friend class T_EGP_RenderPassSceneViewExtension;
 	
 	//Called when this pass is first created (always before the first component registers itself with this pass).
 	//Must call 'FSceneViewExtensions::NewExtension' and return it!
@@ -838,13 +1226,41 @@ protected:
 	
 	UPROPERTY(BlueprintReadOnly, VisibleInstanceOnly, Transient, DisplayName="Registered Components")
 	TSet<U_EGP_RenderPassComponent*> Components_GameThread;
-	TMap<TWeakObjectPtr<const U_EGP_RenderPassComponent>, EGP::CustomRenderPasses::ProxyData_t> ComponentProxies_RenderThread;
+	//Null if the pass's scene-view extension doesn't use components.
+	TUniquePtr<EGP::CustomRenderPasses::FComponentProxyStorage> ComponentProxies_RenderThread;
+
+	//Records a new proxy for the given component, to be sent to the render thread at the end of this frame.
+	//The proxy is relocated into the pass's own memory, so the caller must not destroy it.
+	void QueueProxyUpdate_GameThread(const U_EGP_RenderPassComponent* component,
+									 void* proxy, int32 proxySize,
+									 UPrimitiveComponent* target, const FBoxSphereBounds& targetBounds);
+	//Records that the given component's proxy should be removed on the render thread at the end of this frame.
+	void QueueProxyRemoval_GameThread(const U_EGP_RenderPassComponent* component);
+
+	//Updates the proxies of every component with 'UpdateFromSubsystem' enabled.
+	//Called by the subsystem each frame, right before 'Tick_GameThread()'.
+	void UpdateBatchedComponents_GameThread();
 
 	
 private:
 
-	bool warnedAboutArrayHeapUsage = false;
-	bool warnedAboutProxyHeapUsage = false;
+	//Collects this frame's proxy changes; null until something changes.
+	EGP::CustomRenderPasses::FProxyMailbox* currentMailbox_GameThread = nullptr;
+	//Mailboxes the render thread is done with, ready to be filled again.
+	TQueue<EGP::CustomRenderPasses::FProxyMailbox*, EQueueMode::Spsc> recycledMailboxes;
+	TArray<TUniquePtr<EGP::CustomRenderPasses::FProxyMailbox>> allMailboxes;
+
+	//Components that are updated by 'UpdateBatchedComponents_GameThread()' instead of ticking.
+	//Split by whether they can build their proxies in parallel.
+	TArray<U_EGP_RenderPassComponent*> batchedComponents_GameThread,
+									   parallelBatchedComponents_GameThread;
+
+	//Proxy handles that were released by unregistered components, for re-use.
+	TArray<int32> freeProxyHandles_GameThread;
+	int32 nextProxyHandle_GameThread = 0;
+
+	EGP::CustomRenderPasses::FProxyMailbox& GetMailbox_GameThread();
+	void ApplyMailbox_RenderThread(EGP::CustomRenderPasses::FProxyMailbox& mailbox);
 };
 
 #pragma endregion
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "RenderGraphResources.h"
+
+class FViewInfo;
+
+
+namespace EGP
+{
+	//A mip-chain of reduced scene depth, built by a single compute dispatch.
+	//Mip 0 is half the resolution of the view, and each mip after that halves it again.
+	//Sizes round up, so a view with an odd size still has every one of its pixels covered by the edge texels.
+	//
+	//Depth is stored as raw device-Z, so with reversed-Z the max value is the closest surface.
+	struct EXTENDEDGRAPHICSPROGRAMMING_API FDepthPyramid
+	{
+		static constexpr int MaxMips = 8;
+
+		//Two channels: the furthest (R) and closest (G) depth within each texel's footprint.
+		FRDGTextureRef MinMax = nullptr;
+		//One channel: alternates between the closest and furthest depth in a checkerboard pattern,
+		//    same as the 'Checkerboard' filter of the pixel-shader downsample.
+		FRDGTextureRef Checkerboard = nullptr;
+
+		FIntPoint Mip0Size = FIntPoint::ZeroValue;
+		int NumMips = 0;
+
+		FIntPoint GetMipSize(int mip) const;
+		//Finds the smallest mip that is still at least as detailed as the given resolution.
+		int GetMipForResolution(const FIntPoint& resolution) const;
+	};
+
+	//Reduces the view's part of the given scene depth texture into a new depth pyramid.
+	//The pass only writes UAVs, so if 'asyncCompute' is true (and the platform supports it)
+	//    the RDG will schedule it on the async compute pipe.
+	EXTENDEDGRAPHICSPROGRAMMING_API FDepthPyramid AddDepthPyramidPass(
+		FRDGBuilder& builder, const FViewInfo& view,
+		FRDGTextureRef sceneDepth,
+		bool asyncCompute = true,
+		int maxMips = FDepthPyramid::MaxMips
+	);
+
+	//Gets the depth pyramid for the given view's scene depth, building it on the first request in this graph.
+	//This lets several passes in a frame share one reduction.
+	EXTENDEDGRAPHICSPROGRAMMING_API FDepthPyramid GetDepthPyramid(
+		FRDGBuilder& builder, const FViewInfo& view,
+		FRDGTextureRef sceneDepth
+	);
+}
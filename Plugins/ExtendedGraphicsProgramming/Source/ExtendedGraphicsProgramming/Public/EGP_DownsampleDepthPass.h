@@ -14,4 +14,19 @@ namespace EGP
 		FScreenPassTexture input, FScreenPassRenderTarget output,
 		EDownsampleDepthFilter sampling
 	);
+
+	//Gets the view's scene depth reduced to the given resolution, using the given filter.
+	//The result is a depth-stencil texture, or a two-channel color texture for the 'MinAndMaxDepth' filter.
+	//
+	//Downsampled depth is cached per-frame and per-view: the first request for a given resolution and filter
+	//    runs the downsample, and later requests within the same graph (for example from other EGP passes)
+	//    get the same RDG texture back.
+	//If the requested resolution already matches the view's depth buffer, the depth buffer itself is returned;
+	//    the engine's half-resolution 'SmallDepth' is also returned when it matches a 'Point' request.
+	//The 'Max' and 'Checkerboard' filters are copied out of the shared depth pyramid (see 'GetDepthPyramid()').
+	EXTENDEDGRAPHICSPROGRAMMING_API FRDGTextureRef GetDownsampledDepth(
+		FRDGBuilder& builder, const FViewInfo& view,
+		FRDGTextureRef sceneDepth, const FIntPoint& resolution,
+		EDownsampleDepthFilter sampling
+	);
 }
\ No newline at end of file
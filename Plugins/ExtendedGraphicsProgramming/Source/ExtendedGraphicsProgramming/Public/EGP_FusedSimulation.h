@@ -0,0 +1,124 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Materials/MaterialExpressionCustomOutput.h"
+
+#include "EGP_PostProcessMaterialShaders.h"
+
+#include "EGP_FusedSimulation.generated.h"
+
+/*
+	A "fused" Simulation pass runs several stages of a Material's logic in one compute dispatch,
+	    instead of one AddSimulationMaterialPass() per stage with a full texture write/read in between.
+	Each stage's outputs stay in registers and are handed to the later stages directly.
+
+	The stages all belong to one Material, because a Material is compiled into its own shaders
+	    and there's no way to splice several Materials' code into one dispatch.
+	To compose separate pieces of logic (say "advect", "simulate" and "decay"), author each one as a Material Function
+	    and place them in a single Material, one per stage output.
+
+	To set one up:
+	  1. In your Material, add an "EGP Fused Simulation: Stage" output for each stage, with increasing 'Stage' indices.
+	     Later stages read earlier stages' outputs with a Custom node calling 'EGP_FUSED_STAGE_VALUE(stage, output)'.
+	     Both indices must be literal numbers, e.g. 'EGP_FUSED_STAGE_VALUE(0, 1)'.
+	     That Custom node must add "/EGP/Simulation/fused_values.ush" to its Include File Paths,
+	       as the Material is compiled into non-fused shaders too, where the values read as 0.
+	  2. Inherit your compute shader from FFusedSimulationShader instead of FSimulationShader.
+	  3. In the .usf, include "/EGP/ScreenPass/pre.ush", your own Material inputs, "/EGP/ScreenPass/post.ush",
+	       then "/EGP/Simulation/fused.ush".
+	     After setting up the Material parameters, call 'EGP_RunAllFusedStages()',
+	       or 'EGP_RunFusedStage()' for each stage if you want to run your own logic between them.
+	  4. Call AddFusedSimulationMaterialPass() like you would AddSimulationMaterialPass().
+
+	The Game of Life's Simulate pass ('GOL_Demo/Shaders/Simulate.usf') is an example.
+*/
+
+namespace EGP
+{
+	static constexpr int32 MaxFusedSimulationStages = 8;
+	static constexpr int32 FusedSimulationOutputsPerStage = 4;
+}
+
+//One stage of a fused Simulation pass (see 'EGP_FusedSimulation.h').
+//Each value is converted to a float4.
+UCLASS(CollapseCategories, HideCategories=Object, DisplayName="EGP Fused Simulation: Stage")
+class EXTENDEDGRAPHICSPROGRAMMING_API UMaterialExpressionEGPFusedStageOutputs : public UMaterialExpressionCustomOutput
+{
+	GENERATED_BODY()
+public:
+
+	//Stages run in increasing order. Each index may only be used once per Material.
+	UPROPERTY(EditAnywhere, meta=(ClampMin=0, ClampMax=7))
+	int32 Stage = 0;
+
+	UPROPERTY(meta=(RequiredInput=false))
+	FExpressionInput Value0;
+	UPROPERTY(meta=(RequiredInput=false))
+	FExpressionInput Value1;
+	UPROPERTY(meta=(RequiredInput=false))
+	FExpressionInput Value2;
+	UPROPERTY(meta=(RequiredInput=false))
+	FExpressionInput Value3;
+
+	virtual FString GetFunctionName() const override { return FString::Printf(TEXT("EGP_FusedStage%i_"), Stage); }
+	virtual FString GetDisplayName() const override { return FString::Printf(TEXT("EGP Fused Simulation: Stage %i"), Stage); }
+	virtual bool AllowMultipleCustomOutputs() override { return true; }
+
+	#if WITH_EDITOR
+		virtual void GetCaption(TArray<FString>& output) const override { output.Add(GetDisplayName()); }
+		virtual int32 GetNumOutputs() const override { return EGP::FusedSimulationOutputsPerStage; }
+		virtual EShaderFrequency GetShaderFrequency() override { return SF_Compute; }
+		virtual int32 Compile(class FMaterialCompiler*, int32 pinIdx) override;
+	#endif
+};
+
+namespace EGP
+{
+	//The base class for shaders that run fused Simulation passes.
+	struct EXTENDEDGRAPHICSPROGRAMMING_API FFusedSimulationShader : public FSimulationShader
+	{
+		using FSimulationShader::FSimulationShader;
+		static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters&, FShaderCompilerEnvironment&);
+	};
+
+	//Executes a fused compute Material Shader using the given Material.
+	//Returns false if the pass was skipped because its shaders aren't compiled yet.
+	//
+	//Your shader parameter struct must contain `EGP_SIMULATION_PASS_MATERIAL_DATA()`,
+	//    and its contents will be filled in by this function.
+	template<typename TComputeShader, typename TPassParams, typename SetupFn>
+	bool AddFusedSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+										ERHIFeatureLevel::Type featureLevel,
+										const UMaterialInterface* material,
+										const FSimulationPassMaterialInputs& inputs,
+										const TSimulationPassState<SetupFn>& state,
+										TPassParams* paramStruct)
+	{
+		static_assert(std::is_base_of_v<FFusedSimulationShader, TComputeShader>,
+					  "Your fused Simulation pass shader must inherit from FFusedSimulationShader!");
+		return AddSimulationMaterialPass<TComputeShader, TPassParams, SetupFn>(
+			renderGraph, MoveTemp(event), featureLevel,
+			material, inputs, state, paramStruct
+		);
+	}
+	//Executes a fused compute Material Shader using the given Material.
+	//Returns false if the pass was skipped because its shaders aren't compiled yet.
+	//
+	//Your shader parameter struct must contain `EGP_SIMULATION_PASS_MATERIAL_DATA()`,
+	//    and its contents will be filled in by this function.
+	template<typename TComputeShader, typename TPassParams>
+	bool AddFusedSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+										const FSimulationPassMaterialInputs& inputs,
+										const FSimulationPassState& state,
+										const FViewInfo& view,
+										TPassParams* paramStruct,
+										const UMaterialInterface* material)
+	{
+		static_assert(std::is_base_of_v<FFusedSimulationShader, TComputeShader>,
+					  "Your fused Simulation pass shader must inherit from FFusedSimulationShader!");
+		return AddSimulationMaterialPass<TComputeShader, TPassParams>(
+			renderGraph, MoveTemp(event),
+			inputs, state, view, paramStruct, material
+		);
+	}
+}
@@ -58,7 +58,19 @@ namespace EGP
 			else
 				return NullOpt;
 		
-		const FMaterialRenderProxy* proxy = uMaterial->GetRenderProxy();
+		return FindMaterialShaders_RenderThread(uMaterial->GetRenderProxy(), shaderTypes, settings, predicate);
+	}
+	//Tries to compile the given material shader(s) against a Material's render proxy,
+	//    iterating through fallback Materials until we find an applicable one.
+	//
+	//The predicate lambda should look like '(const EGP::FShaderMapFindCandidate&) -> bool'.
+	template<typename MaterialPredicate>
+	TOptional<FShaderMapFindResult> FindMaterialShaders_RenderThread(const FMaterialRenderProxy* proxy,
+																	 const FMaterialShaderTypes& shaderTypes,
+												   			         FShaderMapFindSettings settings,
+												   			         MaterialPredicate predicate)
+	{
+		check(IsInRenderingThread());
 		check(proxy);
 		
 		//Define the logic for trying to extract shaders from a material.
@@ -84,4 +96,21 @@ namespace EGP
 
 		return NullOpt;
 	}
+
+	//A cached version of 'FindMaterialShaders_RenderThread()', for passes that look up the same shaders every frame.
+	//Entries are keyed by the Material's render proxy, shader types and permutations, and settings.
+	//They're checked against the Material's current shader map at most once per frame,
+	//    and re-resolved when it changes (e.g. the Material was edited and recompiled).
+	//Results that had to use a fallback Material are not cached,
+	//    so the real Material is picked up as soon as its shaders finish compiling.
+	//
+	//Like the uncached version, this returns nothing if no Material in the fallback chain has the shaders yet;
+	//    callers should skip their pass in that case.
+	EXTENDEDGRAPHICSPROGRAMMING_API TOptional<FShaderMapFindResult> FindMaterialShadersCached_RenderThread(const UMaterialInterface* uMaterial,
+																										   const FMaterialShaderTypes& shaderTypes,
+																										   FShaderMapFindSettings settings);
+	//Same as above, for callers that already have the Material's render proxy.
+	EXTENDEDGRAPHICSPROGRAMMING_API TOptional<FShaderMapFindResult> FindMaterialShadersCached_RenderThread(const FMaterialRenderProxy* materialProxy,
+																										   const FMaterialShaderTypes& shaderTypes,
+																										   FShaderMapFindSettings settings);
 }
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include "PrimitiveSceneInfo.h"
 #include "Runtime/Renderer/Private/SceneRendering.h"
 
+class FInstanceCullingManager;
+struct FMeshMaterialShaderPermutationParameters;
+
 namespace EGP
 {
 	//Gathers mesh draw calls for a static mesh.
@@ -20,13 +23,83 @@ namespace EGP
     //In my experience it always ouptuts an empty range for static mesh components, even Movable ones.
     EXTENDEDGRAPHICSPROGRAMMING_API FInt32Range GetDynamicMeshElementRange(const FViewInfo& info, uint32 primitiveIndex);
 
+    //Gets the GPU-Scene instance-culling manager that the view's renderer uses for its own mesh passes,
+    //    or null if GPU-Scene (and therefore GPU instance culling) isn't available for this view.
+    //
+    //Pass this into 'AddSimpleMeshPass()' so that instanced primitives (ISM/HISM, foliage, Niagara mesh particles)
+    //    get their instances culled against the view frustum and compacted on the GPU,
+    //    instead of drawing every instance of every visible primitive.
+    EXTENDEDGRAPHICSPROGRAMMING_API FInstanceCullingManager* GetInstanceCullingManager(const FViewInfo& view);
+
+	//Decides whether a custom mesh pass's shaders should compile for a Material and Vertex Factory,
+	//    for passes that only draw the common kinds of meshes:
+	//    static meshes (including instanced ones and Niagara meshes), skeletal meshes, and landscapes.
+	//Without this, a mesh-material shader compiles for every vertex factory of every surface Material in the project.
+	//
+	//Translucent Materials are skipped unless 'allowTranslucent' is true.
+	//The default Material is never skipped for these vertex factories, so passes can always fall back to it.
+	//
+	//To measure what this saves, run 'r.EGP.CountMeshPassShaders' with your pass's shader type names
+	//    before and after changing it; it reports how many loaded shader maps contain those shaders.
+	EXTENDEDGRAPHICSPROGRAMMING_API bool ShouldCompileCustomMeshPassPermutation(const FMeshMaterialShaderPermutationParameters& params,
+																			   bool allowTranslucent = false);
+
+	//Finds a custom mesh pass's shaders for a mesh batch, along with the Material to draw it with.
+	//If the batch's Material doesn't have the shaders (e.g. it's still compiling, or
+	//    'ShouldCompileCustomMeshPassPermutation()' skipped it), optionally falls back to the default surface Material.
+	//Only fall back if the default Material's outputs are harmless for your pass;
+	//    otherwise, a false return means the batch should be skipped.
+	EXTENDEDGRAPHICSPROGRAMMING_API bool FindMeshPassShaders(const FMeshBatch& batch, ERHIFeatureLevel::Type featureLevel,
+															 const FMaterialShaderTypes& shaderTypes,
+															 bool fallBackToDefaultMaterial,
+															 const FMaterialRenderProxy*& outMaterialProxy,
+															 const FMaterial*& outMaterial,
+															 FMaterialShaders& outShaders);
+
+	//Controls which static-mesh LOD a custom mesh pass draws.
+	//The default values draw the same LOD that the view itself picked.
+	struct FMeshPassLODSettings
+	{
+		//Multiplies each primitive's screen size before its LOD is picked.
+		//Passes that render at a lower resolution than the view should use the ratio of the two resolutions
+		//    (see 'ForResolution()'), so that e.g. a half-resolution pass picks the LOD for a half-size screen.
+		float ScreenSizeScale = 1.0f;
+		//Additional LOD levels to drop after the screen size is taken into account.
+		int LODBias = 0;
+
+		bool UsesViewLOD() const { return ScreenSizeScale == 1.0f && LODBias == 0; }
+
+		static FMeshPassLODSettings ForResolution(const FViewInfo& view, const FIntPoint& passResolution, int lodBias = 0)
+		{
+			FMeshPassLODSettings settings;
+			settings.ScreenSizeScale = FMath::Min(1.0f, static_cast<float>(passResolution.X) /
+														   FMath::Max(1, view.ViewRect.Width()));
+			settings.LODBias = lodBias;
+			return settings;
+		}
+	};
+
+	//Picks the LODs of the primitive's static meshes to draw under the given settings.
+	EXTENDEDGRAPHICSPROGRAMMING_API FLODMask ComputeStaticMeshLOD(const FViewInfo& view, const FPrimitiveSceneInfo& primitive,
+																	  const FMeshPassLODSettings& settings);
+	//Gets the mask of elements within a static mesh batch that should be drawn.
+	EXTENDEDGRAPHICSPROGRAMMING_API uint64 GetStaticMeshElementMask(const FViewInfo& view, const FStaticMeshBatch& staticMesh);
+	//Gets the mask covering every element within a mesh batch.
+	inline uint64 GetAllElementsMask(const FMeshBatch& batch)
+	{
+		return (batch.Elements.Num() >= 64) ? ~0ull : ((1ull << batch.Elements.Num()) - 1);
+	}
+
 	
     //Generates mesh batches for a custom Mesh Pass Processor, on the given primitive.
+	//Static meshes are drawn at the LOD picked by 'lodSettings';
+	//    dynamic meshes are generated by the view, so they always come at the view's own LOD.
 	//
 	//The lambda signature should be
 	//    (const FMeshBatch&, uint64 elementMask, const FPrimitiveSceneProxy*, int staticMeshIDIfApplicable) -> void
     template<typename Lambda>
     void ForEachBatch(const FViewInfo& viewInfo, const FPrimitiveSceneProxy* proxy,
+					  const FMeshPassLODSettings& lodSettings,
 					  Lambda batchProcessor)
     {
     	if (!proxy)
@@ -44,13 +117,30 @@ namespace EGP
     	const auto& primitiveRelevance = viewInfo.PrimitiveViewRelevanceMap[primitiveIdx];
     	if (primitiveRelevance.bStaticRelevance)
     	{
+    		const bool useViewLOD = lodSettings.UsesViewLOD();
+    		const FLODMask lodMask = useViewLOD ? FLODMask{ } : ComputeStaticMeshLOD(viewInfo, *sceneInfo, lodSettings);
     		for (int staticMeshIdx = 0; staticMeshIdx < sceneInfo->StaticMeshes.Num(); ++staticMeshIdx)
     		{
     			const auto& staticMesh = sceneInfo->StaticMeshes[staticMeshIdx];
-    			if (viewInfo.StaticMeshVisibilityMap[staticMesh.Id])
+    			const auto& relevance = sceneInfo->StaticMeshRelevances[staticMeshIdx];
+    			if (!relevance.bUseForMaterial)
+    				continue;
+
+    			bool isDrawn;
+    			if (useViewLOD || staticMesh.bRequiresPerElementVisibility)
+    			{
+    				//Per-element visibility is only computed for the LOD the view picked,
+    				//    so meshes that need it can't switch to a different LOD.
+    				isDrawn = viewInfo.StaticMeshVisibilityMap[staticMesh.Id];
+    			}
+    			else
+    			{
+    				isDrawn = lodMask.ContainsLOD(staticMesh.LODIndex);
+    			}
+
+    			if (isDrawn)
     			{
-    				uint64 defaultBatchElementMask = ~0ull; //TODO: Can we get this somehow from LOD data?
-    				batchProcessor(staticMesh, defaultBatchElementMask,
+    				batchProcessor(staticMesh, GetStaticMeshElementMask(viewInfo, staticMesh),
     							   staticMesh.PrimitiveSceneInfo->Proxy,
     							   staticMeshIdx);
     			}
@@ -72,9 +162,16 @@ namespace EGP
     		for (int32 batchI = dynamicElementRange.GetLowerBoundValue(); batchI < dynamicElementRange.GetUpperBoundValue(); ++batchI)
     		{
     			const FMeshBatchAndRelevance& data = viewInfo.DynamicMeshElements[batchI];
-    			uint64 batchElementMask = ~0ull;
-    			batchProcessor(*data.Mesh, batchElementMask, data.PrimitiveSceneProxy, -1);
+    			batchProcessor(*data.Mesh, GetAllElementsMask(*data.Mesh), data.PrimitiveSceneProxy, -1);
     		}
     	}
     }
+    //Generates mesh batches for a custom Mesh Pass Processor, on the given primitive,
+    //    using the same LODs as the view.
+    template<typename Lambda>
+    void ForEachBatch(const FViewInfo& viewInfo, const FPrimitiveSceneProxy* proxy,
+					  Lambda batchProcessor)
+    {
+    	ForEachBatch(viewInfo, proxy, FMeshPassLODSettings{ }, MoveTemp(batchProcessor));
+    }
 }
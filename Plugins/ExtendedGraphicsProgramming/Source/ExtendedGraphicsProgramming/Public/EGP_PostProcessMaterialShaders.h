@@ -5,6 +5,7 @@
 #include "PostProcess/PostProcessMaterialInputs.h"
 #include "Runtime/Renderer/Private/SceneRendering.h"
 
+#include "ExtendedGraphicsProgramming.h"
 #include "EGP_GetMaterialShader.h"
 
 /*
@@ -25,6 +26,15 @@
 		   (or the templated child versions that provide extra control).
 	  5. Call the correct function for your pass, either
 		   AddSimulationMaterialPass() or AddScreenSpaceRenderPass() or AddScreenSpaceComputePass().
+
+	The shaders are looked up through 'FindMaterialShadersCached_RenderThread()'.
+	If neither the Material nor any of its fallbacks has them compiled yet, the pass is skipped
+	    and the function returns false, so you can keep your own state consistent (e.g. retry next frame).
+
+	To avoid a hitch the first time a Material is used, call PrecacheMaterialComputePSO() or PrecacheMaterialRenderPSO()
+	    when you assign the Material.
+
+	To run several stages of a Material's logic in a single Simulation dispatch, see 'EGP_FusedSimulation.h'.
 */
 
 //First define Simulation passes:
@@ -138,11 +148,12 @@ namespace EGP
 
 	
 	//Executes a compute Material Shader using the given Material.
+	//Returns false if the pass was skipped because its shaders aren't compiled yet.
 	//
 	//Your shader parameter struct must contain `EGP_SIMULATION_PASS_MATERIAL_DATA()`,
 	//    and its contents will be filled in by this function.
 	template<typename TComputeShader, typename TPassParams, typename SetupFn>
-	void AddSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								   ERHIFeatureLevel::Type featureLevel,
 								   const UMaterialInterface* material,
 								   const FSimulationPassMaterialInputs& inputs,
@@ -156,17 +167,20 @@ namespace EGP
 		//Compile the shaders against the Material.
 		FMaterialShaderTypes types;
 		types.AddShaderType<TComputeShader>(state.PermutationID);
-		auto foundShaders = EGP::FindMaterialShaders_RenderThread(
+		auto foundShaders = EGP::FindMaterialShadersCached_RenderThread(
 			material, types,
 			{ MD_PostProcess, featureLevel }
 		);
-		check(foundShaders);
 
 		//Extract the shader and material proxy.
+		TShaderRef<TComputeShader> shaderC;
+		if (!foundShaders || !foundShaders->Shaders.TryGetComputeShader(shaderC))
+		{
+			UE_LOG(LogEGP, Verbose, TEXT("Skipping Simulation pass; its shaders aren't compiled yet"));
+			return false;
+		}
 		auto* materialProxy = foundShaders->MaterialProxy;
 		auto* materialF = foundShaders->Material;
-		TShaderRef<TComputeShader> shaderC;
-		ensure(foundShaders->Shaders.TryGetComputeShader(shaderC));
 
 		//Run the pass.
 		impl::FillSimulationMaterialParams(renderGraph, &paramStruct->SimulationPassData, materialF, inputs);
@@ -234,6 +248,7 @@ namespace EGP
 			//Unhandled case!
 			check(false);
 		}
+		return true;
 	}
 	//Executes a compute Material Shader using the given Material.
 	//
@@ -243,7 +258,7 @@ namespace EGP
 	//While a Simulation pass doesn't conceptually have an associated View,
 	//    unfortunately it appears that Material shaders *need* to refer to one when setting parameters.
 	template<typename TComputeShader, typename TPassParams>
-	void AddSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddSimulationMaterialPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								   const FSimulationPassMaterialInputs& inputs,
 								   const FSimulationPassState& state,
 								   const FViewInfo& view,
@@ -261,7 +276,7 @@ namespace EGP
 									   matProxy, *mat, view);
 		};
 		
-		AddSimulationMaterialPass<TComputeShader, TPassParams, decltype(defaultSetupFn)>(
+		return AddSimulationMaterialPass<TComputeShader, TPassParams, decltype(defaultSetupFn)>(
 			renderGraph, MoveTemp(event), view.FeatureLevel,
 			material, inputs,
 			TSimulationPassState<decltype(defaultSetupFn)>{
@@ -414,7 +429,7 @@ namespace EGP
 	//
 	//See `AddPostProcessMaterialPass()` for sample engine code.
 	template<typename TVertexShader, typename TPixelShader, typename TPassParams, typename SetupFn>
-	void AddScreenSpaceRenderPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddScreenSpaceRenderPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								  const FScreenSpacePassMaterialInputs& inputs,
 								  const TScreenSpacePassRenderState<SetupFn>& state,
 								  TPassParams* paramStruct,
@@ -431,19 +446,23 @@ namespace EGP
 		FMaterialShaderTypes types;
 		types.AddShaderType<TVertexShader>(state.PermutationIdVS);
 		types.AddShaderType<TPixelShader>(state.PermutationIdPS);
-		auto foundShaders = EGP::FindMaterialShaders_RenderThread(
+		auto foundShaders = EGP::FindMaterialShadersCached_RenderThread(
 			material, types,
 			{ MD_PostProcess, inputs.TargetView->FeatureLevel }
 		);
-		check(foundShaders);
 
 		//Extract the shaders and material proxy.
-		auto* materialProxy = foundShaders->MaterialProxy;
-		auto* materialF = foundShaders->Material;
 		TShaderRef<TVertexShader> shaderV;
 		TShaderRef<TPixelShader> shaderP;
-		ensure(foundShaders->Shaders.TryGetVertexShader(shaderV) &&
-			   foundShaders->Shaders.TryGetPixelShader(shaderP));
+		if (!foundShaders ||
+			!foundShaders->Shaders.TryGetVertexShader(shaderV) ||
+			!foundShaders->Shaders.TryGetPixelShader(shaderP))
+		{
+			UE_LOG(LogEGP, Verbose, TEXT("Skipping Screen-Space render pass; its shaders aren't compiled yet"));
+			return false;
+		}
+		auto* materialProxy = foundShaders->MaterialProxy;
+		auto* materialF = foundShaders->Material;
 
 		//Run the pass.
 		impl::FillScreenSpaceMaterialParams(renderGraph, &paramStruct->ScreenSpacePassData,
@@ -467,6 +486,7 @@ namespace EGP
 				setupLambda(cmds, shaderV, shaderP, materialProxy, materialF, view);
 			}
 		);
+		return true;
 	}
 	//Sets up a Screen-Space render pass, with a vertex and pixel shader using a post-process Material.
 	//In most cases you can use 'EGP::FScreenSpaceRenderVS' for your vertex shader.
@@ -481,7 +501,7 @@ namespace EGP
 	//
 	//See `AddPostProcessMaterialPass()` for sample engine code.
 	template<typename TVertexShader, typename TPixelShader, typename TPassParams>
-	void AddScreenSpaceRenderPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddScreenSpaceRenderPass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								  const FScreenSpacePassMaterialInputs& inputs,
 								  const FScreenSpacePassRenderState& state,
 								  TPassParams* paramStruct,
@@ -500,7 +520,7 @@ namespace EGP
 			SetShaderParametersMixedPS(cmds, shaderP, *paramStructInnerPS, matProxy, *mat, view);
 		};
 
-		AddScreenSpaceRenderPass<TVertexShader, TPixelShader, TPassParams, decltype(defaultSetupFn)>(
+		return AddScreenSpaceRenderPass<TVertexShader, TPixelShader, TPassParams, decltype(defaultSetupFn)>(
 			renderGraph, MoveTemp(event), inputs,
 			TScreenSpacePassRenderState<decltype(defaultSetupFn)>{
 				MoveTemp(defaultSetupFn),
@@ -513,7 +533,7 @@ namespace EGP
 
 	//Sets up a screen-space compute pass, using a post-process Material and your compute shader.
 	template<typename TComputeShader, typename TPassParams, typename SetupFn>
-	void AddScreenSpaceComputePass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddScreenSpaceComputePass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								   const FScreenSpacePassMaterialInputs& inputs,
 								   const TScreenSpacePassComputeState<SetupFn>& state,
 								   TPassParams* paramStruct, const UMaterialInterface* material)
@@ -527,17 +547,20 @@ namespace EGP
 		//Compile the shaders against the Material.
 		FMaterialShaderTypes types;
 		types.AddShaderType<TComputeShader>(state.PermutationID);
-		auto foundShaders = EGP::FindMaterialShaders_RenderThread(
+		auto foundShaders = EGP::FindMaterialShadersCached_RenderThread(
 			material, types,
 			{ MD_PostProcess, inputs.TargetView->FeatureLevel }
 		);
-		check(foundShaders);
 
 		//Extract the shader and material proxy.
+		TShaderRef<TComputeShader> shaderC;
+		if (!foundShaders || !foundShaders->Shaders.TryGetComputeShader(shaderC))
+		{
+			UE_LOG(LogEGP, Verbose, TEXT("Skipping Screen-Space compute pass; its shaders aren't compiled yet"));
+			return false;
+		}
 		auto* materialProxy = foundShaders->MaterialProxy;
 		auto* materialF = foundShaders->Material;
-		TShaderRef<TComputeShader> shaderC;
-		ensure(foundShaders->Shaders.TryGetComputeShader(shaderC));
 
 		//Run the pass.
 		impl::FillScreenSpaceMaterialParams(renderGraph, &paramStruct->ScreenSpacePassData, materialF, inputs);
@@ -605,16 +628,18 @@ namespace EGP
 			//Unhandled case!
 			check(false);
 		}
+		return true;
 	}
 	//Sets up a screen-space compute pass, using a post-process Material and your compute shader.
 	template<typename TComputeShader, typename TPassParams>
-	void AddScreenSpaceComputePass(FRDGBuilder& renderGraph, FRDGEventName&& event,
+	bool AddScreenSpaceComputePass(FRDGBuilder& renderGraph, FRDGEventName&& event,
 								   const FScreenSpacePassMaterialInputs& inputs,
 								   const FScreenSpacePassComputeState& state,
 								   TPassParams* paramStruct, const UMaterialInterface* material)
 	{
 		auto defaultSetupFn = [paramStruct]
-								 (FRHICommandList& cmds,
+								 (TOptional<FIntVector3> groupCountIfDirect,
+								  FRHICommandList& cmds,
 								  TShaderRef<TComputeShader> shaderC,
 								  const FMaterialRenderProxy* matProxy, const FMaterial* mat,
 								  const FViewInfo& view)
@@ -622,7 +647,7 @@ namespace EGP
 			SetShaderParametersMixedCS(cmds, shaderC, *paramStruct, matProxy, *mat, view);
 		};
 
-		AddScreenSpaceMaterialPass<TComputeShader, TPassParams, decltype(defaultSetupFn)>(
+		return AddScreenSpaceComputePass<TComputeShader, TPassParams, decltype(defaultSetupFn)>(
 			renderGraph, MoveTemp(event), inputs,
 			TScreenSpacePassComputeState<decltype(defaultSetupFn)>{
 				MoveTemp(defaultSetupFn),
@@ -631,4 +656,79 @@ namespace EGP
 			paramStruct, material
 		);
 	}
-}
\ No newline at end of file
+}
+
+//Finally, PSO precaching for both kinds of passes:
+namespace EGP
+{
+	//Private stuff.
+	namespace impl
+	{
+		//Whether the shaders were found in the given Material itself, rather than a fallback
+		//    (such as the default Material while the given one is still compiling).
+		EXTENDEDGRAPHICSPROGRAMMING_API bool IsFromOwnMaterial(const FShaderMapFindResult& found,
+															   const UMaterialInterface* material,
+															   ERHIFeatureLevel::Type featureLevel);
+		EXTENDEDGRAPHICSPROGRAMMING_API void PrecacheComputePSO(FRHIComputeShader* shader);
+		EXTENDEDGRAPHICSPROGRAMMING_API void PrecacheScreenPassPSO(FRHIVertexShader* shaderV, FRHIPixelShader* shaderP,
+																   const FScreenSpacePassRenderState& state,
+																   EPixelFormat outputFormat, ETextureCreateFlags outputFlags,
+																   uint8 numSamples);
+	}
+
+	//Precaches the pipeline state of a Simulation pass or Screen-Space compute pass,
+	//    so that its first dispatch doesn't create it on demand and hitch.
+	//Call this when the pass's Material is assigned.
+	//Returns false if the Material's own shaders aren't compiled yet, in which case you should try again later.
+	template<typename TComputeShader>
+	bool PrecacheMaterialComputePSO(const UMaterialInterface* material, ERHIFeatureLevel::Type featureLevel,
+									int permutationID = 0)
+	{
+		check(IsInRenderingThread());
+
+		FMaterialShaderTypes types;
+		types.AddShaderType<TComputeShader>(permutationID);
+		auto foundShaders = EGP::FindMaterialShadersCached_RenderThread(material, types, { MD_PostProcess, featureLevel });
+
+		TShaderRef<TComputeShader> shaderC;
+		if (!foundShaders || !impl::IsFromOwnMaterial(*foundShaders, material, featureLevel) ||
+			!foundShaders->Shaders.TryGetComputeShader(shaderC))
+		{
+			return false;
+		}
+
+		impl::PrecacheComputePSO(shaderC.GetComputeShader());
+		return true;
+	}
+
+	//Precaches the pipeline state of a Screen-Space render pass drawing into one render target,
+	//    so that its first draw doesn't create it on demand and hitch.
+	//Call this when the pass's Material is assigned.
+	//Returns false if the Material's own shaders aren't compiled yet, in which case you should try again later.
+	template<typename TVertexShader, typename TPixelShader>
+	bool PrecacheMaterialRenderPSO(const UMaterialInterface* material, ERHIFeatureLevel::Type featureLevel,
+								   const FScreenSpacePassRenderState& state,
+								   EPixelFormat outputFormat, ETextureCreateFlags outputFlags,
+								   uint8 numSamples = 1)
+	{
+		check(IsInRenderingThread());
+
+		FMaterialShaderTypes types;
+		types.AddShaderType<TVertexShader>(state.PermutationIdVS);
+		types.AddShaderType<TPixelShader>(state.PermutationIdPS);
+		auto foundShaders = EGP::FindMaterialShadersCached_RenderThread(material, types, { MD_PostProcess, featureLevel });
+
+		TShaderRef<TVertexShader> shaderV;
+		TShaderRef<TPixelShader> shaderP;
+		if (!foundShaders || !impl::IsFromOwnMaterial(*foundShaders, material, featureLevel) ||
+			!foundShaders->Shaders.TryGetVertexShader(shaderV) ||
+			!foundShaders->Shaders.TryGetPixelShader(shaderP))
+		{
+			return false;
+		}
+
+		impl::PrecacheScreenPassPSO(shaderV.GetVertexShader(), shaderP.GetPixelShader(),
+									state, outputFormat, outputFlags, numSamples);
+		return true;
+	}
+}
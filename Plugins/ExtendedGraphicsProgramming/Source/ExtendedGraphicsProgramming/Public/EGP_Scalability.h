@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "EGP_Scalability.generated.h"
+
+/*
+	EGP render passes read their quality settings from console variables on the render thread every frame,
+	    so they can be changed at any time: from the console, from device profiles, or from Blueprint.
+	Each pass documents its own cvars (for example 'r.EGP.*', 'r.GoL.*', 'r.BRE.*').
+
+	The scalability group 'sg.EGPQuality' sets all of them at once, from 0 (low) to 4 (cinematic),
+	    using the sections [EGPQuality@0] through [EGPQuality@4] of Scalability.ini.
+	Like the engine's own groups, cvars set with a higher priority (e.g. by game settings or the console)
+	    keep their values when the quality level changes.
+
+	By default 'sg.EGPQuality' follows the engine's effects quality ('sg.EffectsQuality'),
+	    so the overall scalability level (and 'UGameUserSettings') controls EGP along with everything else.
+	Once the player picks a level with 'SetQualityLevel()', that level wins instead;
+	    it's saved in GameUserSettings.ini and restored on the next launch.
+*/
+
+namespace EGP
+{
+	static constexpr int32 NumQualityLevels = 5;
+
+	//Gets the current value of 'sg.EGPQuality'.
+	EXTENDEDGRAPHICSPROGRAMMING_API int32 GetQualityLevel();
+	//Sets 'sg.EGPQuality', which applies that level's Scalability.ini section,
+	//    and saves it in GameUserSettings.ini so it's restored next time.
+	//From then on it no longer follows the engine's effects quality.
+	//Game thread only.
+	EXTENDEDGRAPHICSPROGRAMMING_API void SetQualityLevel(int32 level);
+}
+
+UCLASS()
+class EXTENDEDGRAPHICSPROGRAMMING_API U_EGP_ScalabilityLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+public:
+
+	//Gets the quality level of every EGP render pass ('sg.EGPQuality'), from 0 (low) to 4 (cinematic).
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	static int32 GetEGPQualityLevel() { return EGP::GetQualityLevel(); }
+	//Sets the quality level of every EGP render pass ('sg.EGPQuality'), from 0 (low) to 4 (cinematic).
+	//The level is saved with the game's user settings and restored on the next launch.
+	UFUNCTION(BlueprintCallable)
+	static void SetEGPQualityLevel(int32 level) { EGP::SetQualityLevel(level); }
+};
@@ -9,6 +9,21 @@
 #include "EGP_GetMeshBatches.h"
 
 
+static TAutoConsoleVariable<float> CVarBreMaxLoopsScale(
+    TEXT("r.BRE.MaxLoopsScale"),
+    1.0f,
+    TEXT("Scales the maximum number of loop iterations each BRE Material runs per pixel."),
+    ECVF_RenderThreadSafe | ECVF_Scalability
+);
+static TAutoConsoleVariable<float> CVarBreStepLengthScale(
+    TEXT("r.BRE.StepLengthScale"),
+    1.0f,
+    TEXT("Scales how far each BRE loop iteration moves along its ray. ")
+    TEXT("Use together with 'r.BRE.MaxLoopsScale' to trade accuracy for speed without shortening the ray."),
+    ECVF_RenderThreadSafe | ECVF_Scalability
+);
+
+
 class FBreMeshVS : public FMeshMaterialShader
 {
 public:
@@ -16,7 +31,7 @@ public:
 	
     static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& params)
     {
-        return params.MaterialParameters.MaterialDomain == MD_Surface &&
+        return EGP::ShouldCompileCustomMeshPassPermutation(params) &&
                FMeshMaterialShader::ShouldCompilePermutation(params);
     }
 
@@ -26,6 +41,11 @@ public:
 	{
 	}
 };
+struct FBreMeshShaderElementData : public FMeshMaterialShaderElementData
+{
+    float MaxLoopsScale;
+    float StepLengthScale;
+};
 class FBreMeshPS : public FMeshMaterialShader
 {
 public:
@@ -33,7 +53,7 @@ public:
 	
     static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& params)
     {
-        return params.MaterialParameters.MaterialDomain == MD_Surface &&
+        return EGP::ShouldCompileCustomMeshPassPermutation(params) &&
                FMeshMaterialShader::ShouldCompilePermutation(params);
     }
 
@@ -41,7 +61,41 @@ public:
 	FBreMeshPS(const ShaderMetaType::CompiledShaderInitializerType& initializer)
 		: FMeshMaterialShader(initializer)
 	{
+		//Optional because the compiler strips them if the Material's loop is never reached.
+		MaxLoopsScale.Bind(initializer.ParameterMap, TEXT("BreMaxLoopsScale"), SPF_Optional);
+		StepLengthScale.Bind(initializer.ParameterMap, TEXT("BreStepLengthScale"), SPF_Optional);
 	}
+
+	//Binds parameters to the shader to render the given "element".
+	void GetShaderBindings(
+		const FScene* scene,
+		ERHIFeatureLevel::Type featureLevel,
+		const FPrimitiveSceneProxy* primitiveSceneProxy,
+		const FMaterialRenderProxy& materialRenderProxy,
+		const FMaterial& material,
+		#if ENGINE_MINOR_VERSION < 4
+			const FMeshPassProcessorRenderState& drawRenderState,
+		#endif
+		const FBreMeshShaderElementData& element,
+		FMeshDrawSingleShaderBindings& shaderBindings) const
+	{
+		FMeshMaterialShader::GetShaderBindings(
+			scene, featureLevel,
+			primitiveSceneProxy, materialRenderProxy, material,
+			#if ENGINE_MINOR_VERSION < 4
+				drawRenderState,
+			#endif
+			element, shaderBindings
+		);
+
+		shaderBindings.Add(MaxLoopsScale, element.MaxLoopsScale);
+		shaderBindings.Add(StepLengthScale, element.StepLengthScale);
+	}
+
+private:
+
+	LAYOUT_FIELD(FShaderParameter, MaxLoopsScale);
+	LAYOUT_FIELD(FShaderParameter, StepLengthScale);
 };
 IMPLEMENT_MATERIAL_SHADER_TYPE(, FBreMeshVS, TEXT("/GameOfLife/BonusRenderEffect.usf"), TEXT("MainVS"), SF_Vertex);
 IMPLEMENT_MATERIAL_SHADER_TYPE(, FBreMeshPS, TEXT("/GameOfLife/BonusRenderEffect.usf"), TEXT("MainPS"), SF_Pixel);
@@ -153,6 +207,10 @@ public:
 
     FMeshPassProcessorRenderState PassDrawState;
 
+    //Scalability settings, read from 'r.BRE.*' each frame.
+    float MaxLoopsScale = 1.0f,
+          StepLengthScale = 1.0f;
+
     FBreMeshProcessor(const FScene* scene, const FSceneView* view,
                       ERHIFeatureLevel::Type featureLevel,
                       FMeshPassDrawListContext* commandsOutput)
@@ -170,15 +228,11 @@ public:
     virtual void AddMeshBatch(const FMeshBatch& batch, uint64 batchElementMask,
 							  const FPrimitiveSceneProxy* proxy, int32 staticMeshID) override
     {
-        //Get the first usable Material in the chain,
-        //    starting at the batch's desired Material and ending at the Default Material.
-        const FMaterialRenderProxy* fallbackMat = nullptr;
-        const auto& resource = batch.MaterialRenderProxy->GetMaterialWithFallback(
-            FeatureLevel, fallbackMat
-        );
-        const auto& materialProxy = fallbackMat ? *fallbackMat : *batch.MaterialRenderProxy;
-        
-        //Compile our shaders against the batch's Material and Vertex-Factory.
+        //Get our shaders for the batch's Material and Vertex-Factory.
+        //If they weren't compiled for it, skip the batch: the Default Material has no BRE outputs,
+        //    so drawing it would march garbage.
+        const FMaterialRenderProxy* materialProxyPtr;
+        const FMaterial* resourcePtr;
         TMeshProcessorShaders<FBreMeshVS, FBreMeshPS> shaderRefs;
         {
             FMaterialShaderTypes shaderTypes;
@@ -186,15 +240,21 @@ public:
             shaderTypes.AddShaderType<FBreMeshPS>();
 
             FMaterialShaders materialShaders;
-            verify(resource.TryGetShaders(shaderTypes, batch.VertexFactory->GetType(), materialShaders));
+            if (!EGP::FindMeshPassShaders(batch, FeatureLevel, shaderTypes, false,
+                                          materialProxyPtr, resourcePtr, materialShaders))
+                return;
 
             materialShaders.TryGetVertexShader(shaderRefs.VertexShader);
             materialShaders.TryGetPixelShader(shaderRefs.PixelShader);
         }
+        const auto& materialProxy = *materialProxyPtr;
+        const auto& resource = *resourcePtr;
 
         //Configure per-element settings.
-        FMeshMaterialShaderElementData elementData;
+        FBreMeshShaderElementData elementData;
         elementData.InitializeMeshMaterialData(ViewIfDynamicMeshCommand, proxy, batch, staticMeshID, false);
+        elementData.MaxLoopsScale = MaxLoopsScale;
+        elementData.StepLengthScale = StepLengthScale;
 
         //Generate the draw calls for this batch.
         const FMeshDrawingPolicyOverrideSettings overrides = ComputeMeshOverrideSettings(batch);
@@ -210,8 +270,66 @@ public:
             elementData
         );
     }
+
+#if ENGINE_MINOR_VERSION > 3
+    //Reports every pipeline state this pass could use for the given Material and Vertex Factory,
+    //    so the engine can precache them when a component loads.
+    virtual void CollectPSOInitializers(const FSceneTexturesConfig& sceneTexturesConfig,
+                                        const FMaterial& material,
+                                        const FPSOPrecacheVertexFactoryData& vertexFactoryData,
+                                        const FPSOPrecacheParams& precacheParams,
+                                        TArray<FPSOPrecacheData>& outPSOs) override
+    {
+        if (material.GetMaterialDomain() != MD_Surface)
+            return;
+
+        TMeshProcessorShaders<FBreMeshVS, FBreMeshPS> shaderRefs;
+        {
+            FMaterialShaderTypes shaderTypes;
+            shaderTypes.AddShaderType<FBreMeshVS>();
+            shaderTypes.AddShaderType<FBreMeshPS>();
+
+            FMaterialShaders materialShaders;
+            if (!material.TryGetShaders(shaderTypes, vertexFactoryData.VertexFactoryType, materialShaders))
+                return;
+
+            materialShaders.TryGetVertexShader(shaderRefs.VertexShader);
+            materialShaders.TryGetPixelShader(shaderRefs.PixelShader);
+        }
+
+        //The pass draws into scene color, testing against scene depth.
+        FGraphicsPipelineRenderTargetsInfo renderTargets;
+        renderTargets.NumSamples = sceneTexturesConfig.NumSamples;
+        AddRenderTargetInfo(sceneTexturesConfig.ColorFormat, sceneTexturesConfig.ColorCreateFlags, renderTargets);
+        SetupDepthStencilInfo(PF_DepthStencil, sceneTexturesConfig.DepthCreateFlags,
+                              ERenderTargetLoadAction::ELoad, ERenderTargetLoadAction::ELoad,
+                              FExclusiveDepthStencil::DepthWrite_StencilNop, renderTargets);
+
+        const FMeshDrawingPolicyOverrideSettings overrides = ComputeMeshOverrideSettings(precacheParams);
+        auto cullMode = ComputeMeshCullMode(material, overrides);
+        if (cullMode == ERasterizerCullMode::CM_None) //Same as in AddMeshBatch()
+            cullMode = ERasterizerCullMode::CM_CW;
+        AddGraphicsPipelineStateInitializer(
+            vertexFactoryData, material, PassDrawState, renderTargets, shaderRefs,
+            ComputeMeshFillMode(material, overrides), cullMode,
+            static_cast<EPrimitiveType>(precacheParams.PrimitiveType),
+            EMeshPassFeatures::Default, true, outPSOs
+        );
+    }
+#endif
 };
 
+#if ENGINE_MINOR_VERSION > 3
+//Registers the mesh pass with the engine's PSO precaching.
+static IPSOCollector* CreateBrePSOCollector(ERHIFeatureLevel::Type featureLevel)
+{
+    return new FBreMeshProcessor(nullptr, nullptr, featureLevel, nullptr);
+}
+static FRegisterPSOCollectorCreateFunction RegisterBrePSOCollector(
+    &CreateBrePSOCollector, EShadingPath::Deferred, TEXT("BonusRenderEffect")
+);
+#endif
+
 BEGIN_SHADER_PARAMETER_STRUCT(FBrePassParameters, )
 	SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, View)
 	SHADER_PARAMETER_RDG_UNIFORM_BUFFER(FSceneUniformParameters, Scene)
@@ -250,16 +368,20 @@ struct FBrePassSVE : public T_EGP_RenderPassSceneViewExtension<UBreRenderPass,
 			FIntPoint::ZeroValue,
 			passParams->RenderTargets[0].GetTexture()->Desc.Extent
 		};
-		AddSimpleMeshPass(graph, passParams, renderScene, view, nullptr,
+		AddSimpleMeshPass(graph, passParams, renderScene, view, EGP::GetInstanceCullingManager(view),
 						  RDG_EVENT_NAME("SnkeBonusRenderEffect"),
 						  viewport, ERDGPassFlags::Raster,
 					      [&](FDynamicPassMeshDrawListContext* output)
 		{
+			if (renderScene == nullptr)
+				return;
+
 			FBreMeshProcessor meshProcessor{renderScene, &view, view.FeatureLevel, output };
-			ForEachComponent_RenderThread([&](const UBreComponent& component,
-											  const FBrePrimitiveSettings& settings,
-											  const UPrimitiveComponent& primitive,
-											  const FPrimitiveSceneProxy& primitiveProxy)
+			meshProcessor.MaxLoopsScale = FMath::Max(0.0f, CVarBreMaxLoopsScale.GetValueOnRenderThread());
+			meshProcessor.StepLengthScale = FMath::Max(0.0f, CVarBreStepLengthScale.GetValueOnRenderThread());
+			ForEachVisibleComponent_RenderThread(*renderScene, view,
+												 [&](const FBrePrimitiveSettings& settings,
+													 const FPrimitiveSceneProxy& primitiveProxy)
 			{
 				EGP::ForEachBatch(view, &primitiveProxy,
 								   [&](const FMeshBatch& batch, uint64 mask, const auto* sceneProxy, int staticMeshID)
@@ -271,10 +393,28 @@ struct FBrePassSVE : public T_EGP_RenderPassSceneViewExtension<UBreRenderPass,
 	}
 };
 
+UBreComponent::UBreComponent()
+{
+	UpdateFromSubsystem = true;
+	PrimaryComponentTick.bCanEverTick = false;
+}
 TSubclassOf<U_EGP_RenderPass> UBreComponent::GetPassType() const
 {
 	return UBreRenderPass::StaticClass();
 }
+
+FBreScalabilitySettings UBreUtilities::GetBreScalabilitySettings()
+{
+	FBreScalabilitySettings settings;
+	settings.MaxLoopsScale = CVarBreMaxLoopsScale.GetValueOnGameThread();
+	settings.StepLengthScale = CVarBreStepLengthScale.GetValueOnGameThread();
+	return settings;
+}
+void UBreUtilities::SetBreScalabilitySettings(const FBreScalabilitySettings& settings)
+{
+	CVarBreMaxLoopsScale->Set(FMath::Max(0.0f, settings.MaxLoopsScale), ECVF_SetByGameSetting);
+	CVarBreStepLengthScale->Set(FMath::Max(0.0f, settings.StepLengthScale), ECVF_SetByGameSetting);
+}
 TSharedRef<F_EGP_RenderPassSceneViewExtension> UBreRenderPass::InitThisPass_GameThread(UWorld& thisWorld)
 {
 	return FSceneViewExtensions::NewExtension<FBrePassSVE>(this);
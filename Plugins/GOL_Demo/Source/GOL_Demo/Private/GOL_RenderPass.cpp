@@ -1,22 +1,57 @@
 #include "GOL_RenderPass.h"
 
 #include "Landscape.h"
+#include "Algo/BinarySearch.h"
 #include "MaterialCompiler.h"
+#include "Misc/Compression.h"
 #include "RenderGraphUtils.h"
+#include "RenderUtils.h"
+#include "SceneTexturesConfig.h"
 #include "SimpleMeshDrawCommandPass.h"
 #include "Runtime/Renderer/Private/PostProcess/PostProcessing.h"
 #include "Runtime/Renderer/Public/MeshPassProcessor.inl"
 
 #include "EGP_GetMeshBatches.h"
 #include "EGP_PostProcessMaterialShaders.h"
+#include "EGP_FusedSimulation.h"
 #include "EGP_DownsampleDepthPass.h"
-
-
-FRHITextureCreateDesc FGameOfLifeView::SimStateDesc(const FInt32Point& viewportSize)
+#include "EGP_DepthPyramid.h"
+
+
+static TAutoConsoleVariable<int32> CVarGoLSimResolutionDivisor(
+    TEXT("r.GoL.SimResolutionDivisor"),
+    0,
+    TEXT("If above 0, overrides every Game of Life pass's 'SimResolutionDivisor': ")
+    TEXT("sims run at their viewport's resolution divided by this."),
+    ECVF_RenderThreadSafe | ECVF_Scalability
+);
+static TAutoConsoleVariable<int32> CVarGoLTickDivisor(
+    TEXT("r.GoL.TickDivisor"),
+    1,
+    TEXT("Game of Life sims only tick once every this many frames, on top of their view policy's own 'TickDivisor'."),
+    ECVF_RenderThreadSafe | ECVF_Scalability
+);
+static TAutoConsoleVariable<int32> CVarGoLEdgeAwareUpsample(
+    TEXT("r.GoL.EdgeAwareUpsample"),
+    -1,
+    TEXT("Whether Game of Life sims are upsampled along depth edges before being displayed.\n")
+    TEXT("-1 = use each pass's 'EdgeAwareUpsample' setting, 0 = never, 1 = always."),
+    ECVF_RenderThreadSafe | ECVF_Scalability
+);
+static TAutoConsoleVariable<float> CVarGoLUpsampleDepthSharpness(
+    TEXT("r.GoL.EdgeAwareUpsample.DepthSharpness"),
+    20.0f,
+    TEXT("How quickly a cell's weight in the edge-aware upsample falls off as its depth moves away from the pixel's, ")
+    TEXT("relative to the pixel's depth. At 20, a cell 5% nearer or farther than the pixel has a third of its usual weight."),
+    ECVF_RenderThreadSafe | ECVF_Scalability
+);
+
+
+FRHITextureCreateDesc FGameOfLifeView::SimStateDesc(const FInt32Point& viewportSize, int32 resolutionDivisor)
 {
-    //The sim looks pretty nice running at half-resolution;
+    //The sim looks pretty nice running at half-resolution (the default);
     //    doing this also cuts the performance cost by 75%.
-    auto texSize = viewportSize / 2;
+    auto texSize = FInt32Point::ComponentMax(viewportSize / FMath::Max(1, resolutionDivisor), { 1, 1 });
     
     auto d = FRHITextureCreateDesc::Create2D(
         TEXT("GoL_State"),
@@ -28,6 +63,19 @@ FRHITextureCreateDesc FGameOfLifeView::SimStateDesc(const FInt32Point& viewportS
     return d;
 }
 
+uint64 FGameOfLifeView::GetGPUMemoryBytes() const
+{
+    uint64 total = 0;
+    for (const auto* tex : { SimState.GetReference(), SimBuffer.GetReference() })
+    {
+        if (tex == nullptr)
+            continue;
+        const auto& desc = tex->GetDesc();
+        total += CalcTextureSize(desc.Extent.X, desc.Extent.Y, desc.Format, desc.NumMips);
+    }
+    return total;
+}
+
 #pragma region Initialize the sim state for new viewports
 
 struct FGoLInitializePS : public EGP::FScreenSpaceShader
@@ -43,27 +91,8 @@ struct FGoLInitializePS : public EGP::FScreenSpaceShader
 
 IMPLEMENT_MATERIAL_SHADER_TYPE(, FGoLInitializePS, TEXT("/GameOfLife/Init.usf"), TEXT("Main"), SF_Pixel);
 
-static void EnsureCompiledSimulateShader(ERHIFeatureLevel::Type featureLevel, const UMaterialInterface* uMaterial)
-{
-    FMaterialShaderTypes types;
-    types.AddShaderType<EGP::FScreenSpaceRenderVS>();
-    types.AddShaderType<FGoLInitializePS>();
-    auto foundShaders = EGP::FindMaterialShaders_RenderThread(
-        uMaterial, types,
-        { MD_PostProcess, featureLevel }
-    );
-    check(foundShaders);
-
-    //Extract the shader and material proxy.
-    auto* materialProxy = foundShaders->MaterialProxy;
-    auto* materialF = foundShaders->Material;
-    TShaderRef<EGP::FScreenSpaceRenderVS> shaderV;
-    TShaderRef<FGoLInitializePS> shaderP;
-    ensure(foundShaders->Shaders.TryGetVertexShader(shaderV));
-    ensure(foundShaders->Shaders.TryGetPixelShader(shaderP));
-}
-
-static void InitGoLState(FRDGBuilder& graph, FRDGTextureRef simStateTex,
+//Returns false if the Material's shaders aren't ready yet.
+static bool InitGoLState(FRDGBuilder& graph, FRDGTextureRef simStateTex,
                          const FViewInfo& view, const FSceneTextureShaderParameters& sceneTextures,
                          const UMaterialInterface* uMaterial)
 {
@@ -76,7 +105,7 @@ static void InitGoLState(FRDGBuilder& graph, FRDGTextureRef simStateTex,
     postProcessMaterialInputs.OutputViewportData = FScreenPassTextureViewport{ simStateTex };
     postProcessMaterialInputs.InputViewportData = FScreenPassTextureViewport{ view.ViewRect };
 
-    EGP::AddScreenSpaceRenderPass<EGP::FScreenSpaceRenderVS, FGoLInitializePS>(
+    return EGP::AddScreenSpaceRenderPass<EGP::FScreenSpaceRenderVS, FGoLInitializePS>(
         graph, RDG_EVENT_NAME("GoL_Initialize"),
         postProcessMaterialInputs,
         EGP::FScreenSpacePassRenderState{ }, //Default to opaque blending and no depth/stencil usage
@@ -88,15 +117,18 @@ static void InitGoLState(FRDGBuilder& graph, FRDGTextureRef simStateTex,
 
 FGameOfLifeView::FGameOfLifeView(FRDGBuilder& graph, const FViewInfo& view, const FIntRect& viewportSubset,
                                  const UMaterialInterface* initShaderMaterial,
-                                 const FSceneTextureShaderParameters& sceneTextures)
-    : F_EGP_ViewPersistentData(graph, view, viewportSubset)
+                                 const FSceneTextureShaderParameters& sceneTextures,
+                                 int32 resolutionDivisor)
+    : F_EGP_ViewPersistentData(graph, view, viewportSubset),
+      ResolutionDivisor(resolutionDivisor)
 {
-    auto desc = SimStateDesc(viewportSubset.Size());
+    auto desc = SimStateDesc(viewportSubset.Size(), ResolutionDivisor);
     SimState = RHICreateTexture(desc);
     SimBuffer = RHICreateTexture(desc);
 
     auto simStateRDG = RegisterExternalTexture(graph, SimState, TEXT("GoL_InitialState"));
-    InitGoLState(graph, simStateRDG, view, sceneTextures, initShaderMaterial);
+    //If the Material's shaders are still compiling, try again next frame.
+    ReinitializeViews = !InitGoLState(graph, simStateRDG, view, sceneTextures, initShaderMaterial);
 }
 
 #pragma endregion
@@ -126,8 +158,20 @@ void FGameOfLifeView::Resample(FRDGBuilder& graph, const FViewInfo& view,
     if (oldResolution == newResolution)
         return;
 
+    ResampleSimState(graph, view, newResolution);
+}
+void FGameOfLifeView::SetResolutionDivisor(FRDGBuilder& graph, const FViewInfo& view, int32 newDivisor)
+{
+    if (newDivisor == ResolutionDivisor)
+        return;
+
+    ResolutionDivisor = newDivisor;
+    ResampleSimState(graph, view, view.ViewRect.Size());
+}
+void FGameOfLifeView::ResampleSimState(FRDGBuilder& graph, const FViewInfo& view, const FInt32Point& newViewportSize)
+{
     auto oldState = SimState;
-    auto newDesc = SimStateDesc({ newResolution.X, newResolution.Y });
+    auto newDesc = SimStateDesc(newViewportSize, ResolutionDivisor);
     SimState = RHICreateTexture(newDesc);
     SimBuffer = RHICreateTexture(newDesc);
 
@@ -155,6 +199,214 @@ void FGameOfLifeView::Resample(FRDGBuilder& graph, const FViewInfo& view,
 
 #pragma endregion
 
+#pragma region Park idle views in system memory
+
+struct FGoLUnparkCS : public FGlobalShader
+{
+    DECLARE_GLOBAL_SHADER(FGoLUnparkCS);
+    static constexpr int GroupSize = 8;
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<uint>, PackedState)
+        SHADER_PARAMETER(FUintVector2, Resolution)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float2>, SimStateTex)
+    END_SHADER_PARAMETER_STRUCT()
+    SHADER_USE_PARAMETER_STRUCT(FGoLUnparkCS, FGlobalShader)
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& params,
+                                             FShaderCompilerEnvironment& env)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(params, env);
+        env.SetDefine(TEXT("UNPARK_GROUP_SIZE"), GroupSize);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGoLUnparkCS, "/GameOfLife/Unpark.usf", "Main", SF_Compute);
+
+//Parked sims are bit-packed in this many bytes.
+static int32 GetPackedBytes(const FIntPoint& resolution)
+{
+    return FMath::DivideAndRoundUp(resolution.X * resolution.Y, 32) * static_cast<int32>(sizeof(uint32));
+}
+
+bool FGameOfLifeView::BeginParking(FRDGBuilder& graph)
+{
+    parkingReadback = MakeUnique<FRHIGPUTextureReadback>(TEXT("GoL_ParkingReadback"));
+    AddEnqueueCopyPass(graph, parkingReadback.Get(),
+                       RegisterExternalTexture(graph, SimState, TEXT("GoL_State")));
+    return true;
+}
+bool FGameOfLifeView::TryFinishParking()
+{
+    //Once the cells are compressed, release the GPU memory.
+    //Until then the sim textures stay alive, so the view can come back without waiting on anything.
+    if (parkedState.IsValid())
+    {
+        if (!parkedState.IsCompleted())
+            return false;
+
+        parkedCompressed = MoveTemp(parkedState.GetResult());
+        parkedState = { };
+        SimState = nullptr;
+        SimBuffer = nullptr;
+        return true;
+    }
+
+    check(parkingReadback.IsValid());
+    if (!parkingReadback->IsReady())
+        return false;
+
+    //Pack each cell's discrete state into one bit.
+    parkedSize = SimState->GetDesc().Extent;
+    parkedPackedBytes = GetPackedBytes(parkedSize);
+    TArray<uint32> packed;
+    packed.SetNumZeroed(parkedPackedBytes / sizeof(uint32));
+    {
+        int32 rowPitchInPixels;
+        const auto* pixels = static_cast<const uint8*>(parkingReadback->Lock(rowPitchInPixels));
+        for (int32 y = 0; y < parkedSize.Y; ++y)
+        {
+            const auto* row = pixels + (y * rowPitchInPixels * 2); //R8G8
+            for (int32 x = 0; x < parkedSize.X; ++x)
+                if (row[x * 2] >= 128)
+                {
+                    const int32 bitI = x + (y * parkedSize.X);
+                    packed[bitI / 32] |= 1u << (bitI % 32);
+                }
+        }
+        parkingReadback->Unlock();
+    }
+    parkingReadback.Reset();
+
+    //Compress in the background, and check back on later frames.
+    parkedState = UE::Tasks::Launch(UE_SOURCE_LOCATION, [packed = MoveTemp(packed)]()
+    {
+        const int32 srcBytes = packed.Num() * sizeof(uint32);
+        int32 compressedBytes = FCompression::CompressMemoryBound(NAME_Zlib, srcBytes);
+        TArray<uint8> compressed;
+        compressed.SetNumUninitialized(compressedBytes);
+        verify(FCompression::CompressMemory(NAME_Zlib, compressed.GetData(), compressedBytes,
+                                            packed.GetData(), srcBytes));
+        compressed.SetNum(compressedBytes);
+        return compressed;
+    });
+    return false;
+}
+void FGameOfLifeView::CancelParking()
+{
+    //The sim textures haven't been released yet, so just drop the work in flight.
+    //A running compression task finishes on its own and its result is thrown away.
+    parkingReadback.Reset();
+    parkedState = { };
+}
+void FGameOfLifeView::Unpark(FRDGBuilder& graph, const FViewInfo& view)
+{
+    //Parking only finishes once the cells are compressed, so nothing here has to wait.
+    TArray<uint32> packed;
+    packed.SetNumUninitialized(parkedPackedBytes / sizeof(uint32));
+    verify(FCompression::UncompressMemory(NAME_Zlib, packed.GetData(), parkedPackedBytes,
+                                          parkedCompressed.GetData(), parkedCompressed.Num()));
+    parkedCompressed.Empty();
+
+    auto desc = SimStateDesc({ 1, 1 });
+    desc.SetExtent(parkedSize);
+    SimState = RHICreateTexture(desc);
+    SimBuffer = RHICreateTexture(desc);
+    //Don't make up for all the time spent parked in one big tick.
+    NextTickTime = 0;
+
+    auto* params = graph.AllocParameters<FGoLUnparkCS::FParameters>();
+    params->PackedState = graph.CreateSRV(CreateStructuredBuffer(graph, TEXT("GoL_ParkedState"), packed));
+    params->Resolution = { static_cast<uint32>(parkedSize.X), static_cast<uint32>(parkedSize.Y) };
+    params->SimStateTex = graph.CreateUAV(RegisterExternalTexture(graph, SimState, TEXT("GoL_State")));
+    FComputeShaderUtils::AddPass(
+        graph, RDG_EVENT_NAME("GoL_Unpark %ix%i", parkedSize.X, parkedSize.Y),
+        TShaderMapRef<FGoLUnparkCS>{ view.ShaderMap },
+        params, FComputeShaderUtils::GetGroupCount(parkedSize, FGoLUnparkCS::GroupSize)
+    );
+}
+uint64 FGameOfLifeView::GetParkedBytes() const
+{
+    return parkedCompressed.GetAllocatedSize();
+}
+
+#pragma endregion
+
+#pragma region Upsample the sim state for display
+
+struct FGoLUpsampleCS : public FGlobalShader
+{
+    DECLARE_GLOBAL_SHADER(FGoLUpsampleCS);
+    static constexpr int GroupSize = 8;
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, View)
+        SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float2>, SimStateTex)
+        SHADER_PARAMETER(FUintVector2, SimResolution)
+        SHADER_PARAMETER_RDG_TEXTURE_SRV(Texture2D<float2>, CellDepthTex)
+        SHADER_PARAMETER(FUintVector2, CellDepthResolution)
+        SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, SceneDepthTex)
+        SHADER_PARAMETER(FUintVector2, ViewMin)
+        SHADER_PARAMETER(FUintVector2, ViewSize)
+        SHADER_PARAMETER(float, DepthSharpness)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float2>, UpsampledStateTex)
+    END_SHADER_PARAMETER_STRUCT()
+    SHADER_USE_PARAMETER_STRUCT(FGoLUpsampleCS, FGlobalShader)
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& params,
+                                             FShaderCompilerEnvironment& env)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(params, env);
+        env.SetDefine(TEXT("UPSAMPLE_GROUP_SIZE"), GroupSize);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGoLUpsampleCS, "/GameOfLife/Upsample.usf", "Main", SF_Compute);
+
+//Upsamples the sim state to the view's resolution without bleeding across depth edges,
+//    guided by the scene depth and the closest depth under each cell (from the shared depth pyramid).
+//The result is a separate full-resolution texture rather than being folded into the display pass,
+//    because the display pass runs the user's effect Material, which samples its input through
+//    the usual post-process texture slot; it's only two bytes per pixel.
+static FRDGTextureRef UpsampleGoLState(FRDGBuilder& graph, const FViewInfo& view,
+                                       FRDGTextureRef simStateTex, FRDGTextureRef sceneDepth)
+{
+    const auto simResolution = simStateTex->Desc.Extent;
+    const auto viewSize = view.ViewRect.Size();
+
+    const auto depthPyramid = EGP::GetDepthPyramid(graph, view, sceneDepth);
+    const int depthMip = depthPyramid.GetMipForResolution(simResolution);
+    const auto depthMipSize = depthPyramid.GetMipSize(depthMip);
+
+    auto upsampled = graph.CreateTexture(
+        FRDGTextureDesc::Create2D(viewSize, simStateTex->Desc.Format, FClearValueBinding::None,
+                                  TexCreate_ShaderResource | TexCreate_UAV),
+        TEXT("GoL_UpsampledState")
+    );
+
+    auto* params = graph.AllocParameters<FGoLUpsampleCS::FParameters>();
+    params->View = view.ViewUniformBuffer;
+    params->SimStateTex = simStateTex;
+    params->SimResolution = FUintVector2(simResolution.X, simResolution.Y);
+    params->CellDepthTex = graph.CreateSRV(FRDGTextureSRVDesc::CreateForMipLevel(depthPyramid.MinMax, depthMip));
+    params->CellDepthResolution = FUintVector2(depthMipSize.X, depthMipSize.Y);
+    params->SceneDepthTex = sceneDepth;
+    params->ViewMin = FUintVector2(view.ViewRect.Min.X, view.ViewRect.Min.Y);
+    params->ViewSize = FUintVector2(viewSize.X, viewSize.Y);
+    params->DepthSharpness = FMath::Max(0.0f, CVarGoLUpsampleDepthSharpness.GetValueOnRenderThread());
+    params->UpsampledStateTex = graph.CreateUAV(upsampled);
+
+    FComputeShaderUtils::AddPass(
+        graph, RDG_EVENT_NAME("GoL_Upsample %dx%d -> %dx%d",
+                              simResolution.X, simResolution.Y, viewSize.X, viewSize.Y),
+        TShaderMapRef<FGoLUpsampleCS>{ view.ShaderMap },
+        params, FComputeShaderUtils::GetGroupCount(viewSize, FGoLUpsampleCS::GroupSize)
+    );
+    return upsampled;
+}
+
+#pragma endregion
+
 #pragma region Display the sim state as a post-process
 
 struct FGoLDisplayPS : public EGP::FScreenSpaceShader
@@ -170,7 +422,13 @@ struct FGoLDisplayPS : public EGP::FScreenSpaceShader
 
 IMPLEMENT_MATERIAL_SHADER_TYPE(, FGoLDisplayPS, TEXT("/GameOfLife/Display.usf"), TEXT("Main"), SF_Pixel);
 
-static void RenderGoLState(FRDGBuilder& graph, const FViewInfo& view,
+//The sim is multiplied onto the scene color.
+static FRHIBlendState* GetGoLDisplayBlendState()
+{
+    return TStaticBlendState<CW_RGBA, BO_Add, BF_DestColor, BF_Zero>::GetRHI();
+}
+
+static bool RenderGoLState(FRDGBuilder& graph, const FViewInfo& view,
                            FRDGTextureRef simStateTex,
                            FRHIBlendState* blending,
                            const FRenderTargetBinding& output,
@@ -191,7 +449,7 @@ static void RenderGoLState(FRDGBuilder& graph, const FViewInfo& view,
     inputs.InputViewportData = FScreenPassTextureViewport{ inputs.Textures[0].Texture };
     inputs.OutputViewportData = FScreenPassTextureViewport{ output.GetTexture(), view.ViewRect };
     
-    EGP::AddScreenSpaceRenderPass<EGP::FScreenSpaceRenderVS, FGoLDisplayPS>(
+    return EGP::AddScreenSpaceRenderPass<EGP::FScreenSpaceRenderVS, FGoLDisplayPS>(
         graph, RDG_EVENT_NAME("GoL_Display"), inputs,
         EGP::FScreenSpacePassRenderState{ blending },
         params, material,
@@ -200,11 +458,126 @@ static void RenderGoLState(FRDGBuilder& graph, const FViewInfo& view,
     );
 }
 
+//The tiled display splits the screen into tiles of this many pixels on each side.
+static constexpr int GoLDisplayTileSize = 8;
+
+struct FGoLClassifyDisplayTilesCS : public FGlobalShader
+{
+    DECLARE_GLOBAL_SHADER(FGoLClassifyDisplayTilesCS);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float2>, SimStateTex)
+        SHADER_PARAMETER(FUintVector2, SimResolution)
+        SHADER_PARAMETER(FVector2f, ViewSize)
+        SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<uint>, DisplayTiles)
+        SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, DisplayIndirectArgs)
+    END_SHADER_PARAMETER_STRUCT()
+    SHADER_USE_PARAMETER_STRUCT(FGoLClassifyDisplayTilesCS, FGlobalShader)
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& params,
+                                             FShaderCompilerEnvironment& env)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(params, env);
+        env.SetDefine(TEXT("DISPLAY_TILE_SIZE"), GoLDisplayTileSize);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGoLClassifyDisplayTilesCS, "/GameOfLife/DisplayTiles.usf", "Main", SF_Compute);
+
+struct FGoLDisplayCS : public EGP::FScreenSpaceShader
+{
+    DECLARE_EXPORTED_SHADER_TYPE(FGoLDisplayCS, Material, )
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        EGP_SCREEN_SPACE_PASS_MATERIAL_DATA()
+        SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<uint>, DisplayTiles)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, SceneColorOutput)
+        RDG_BUFFER_ACCESS(DisplayIndirectArgs, ERHIAccess::IndirectArgs)
+    END_SHADER_PARAMETER_STRUCT()
+    SHADER_USE_PARAMETER_STRUCT_WITH_LEGACY_BASE(FGoLDisplayCS, EGP::FScreenSpaceShader)
+
+    static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& params,
+                                             FShaderCompilerEnvironment& env)
+    {
+        EGP::FScreenSpaceShader::ModifyCompilationEnvironment(params, env);
+        env.SetDefine(TEXT("DISPLAY_TILE_SIZE"), GoLDisplayTileSize);
+    }
+};
+
+IMPLEMENT_MATERIAL_SHADER_TYPE(, FGoLDisplayCS, TEXT("/GameOfLife/Display.usf"), TEXT("MainCS"), SF_Compute);
+
+//The tiled display writes straight into scene color, which not every platform allows.
+static bool CanDisplayGoLTiles(FRDGTextureRef sceneColor)
+{
+    const auto& desc = sceneColor->Desc;
+    return EnumHasAnyFlags(desc.Flags, TexCreate_UAV) &&
+           desc.NumSamples == 1 &&
+           UE::PixelFormat::HasCapabilities(desc.Format, EPixelFormatCapabilities::TypedUAVLoad);
+}
+
+//Like 'RenderGoLState()', but skips screen tiles where every cell is dead.
+//Tiles are classified from the sim itself, while the Material displays 'displayedStateTex'
+//    (which may be the sim upsampled to the view's resolution).
+//Returns false (having drawn nothing) if the Material's compute shader isn't ready yet.
+static bool RenderGoLStateTiled(FRDGBuilder& graph, const FViewInfo& view,
+                                FRDGTextureRef simStateTex, FRDGTextureRef displayedStateTex,
+                                FRDGTextureRef sceneColor,
+                                const UMaterialInterface* material,
+                                const FSceneTextureShaderParameters& sceneTextures)
+{
+    const auto numTiles = FIntPoint::DivideAndRoundUp(view.ViewRect.Size(), GoLDisplayTileSize);
+
+    //List the tiles that have any living cells.
+    auto tiles = graph.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(sizeof(uint32), numTiles.X * numTiles.Y),
+                                    TEXT("GoL_DisplayTiles"));
+    auto indirectArgs = graph.CreateBuffer(FRDGBufferDesc::CreateIndirectDesc<FRHIDispatchIndirectParameters>(1),
+                                           TEXT("GoL_DisplayIndirectArgs"));
+    auto indirectArgsUAV = graph.CreateUAV(indirectArgs, PF_R32_UINT);
+    AddClearUAVPass(graph, indirectArgsUAV, 0u);
+
+    auto* classifyParams = graph.AllocParameters<FGoLClassifyDisplayTilesCS::FParameters>();
+    classifyParams->SimStateTex = simStateTex;
+    classifyParams->SimResolution = FUintVector2(simStateTex->Desc.Extent.X, simStateTex->Desc.Extent.Y);
+    classifyParams->ViewSize = FVector2f(view.ViewRect.Size());
+    classifyParams->DisplayTiles = graph.CreateUAV(tiles);
+    classifyParams->DisplayIndirectArgs = indirectArgsUAV;
+    FComputeShaderUtils::AddPass(
+        graph, RDG_EVENT_NAME("GoL_ClassifyDisplayTiles %dx%d", numTiles.X, numTiles.Y),
+        TShaderMapRef<FGoLClassifyDisplayTilesCS>{ view.ShaderMap },
+        classifyParams, FIntVector{ numTiles.X, numTiles.Y, 1 }
+    );
+
+    //Display those tiles.
+    auto* params = graph.AllocParameters<FGoLDisplayCS::FParameters>();
+    params->DisplayTiles = graph.CreateSRV(tiles);
+    params->SceneColorOutput = graph.CreateUAV(sceneColor);
+    params->DisplayIndirectArgs = indirectArgs;
+
+    EGP::FScreenSpacePassMaterialInputs inputs;
+    inputs.Textures[0] = GetScreenPassTextureInput(
+        FScreenPassTexture{ displayedStateTex },
+        TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp>::GetRHI()
+    );
+    inputs.SceneTextures = sceneTextures;
+    inputs.TargetView = &view;
+    inputs.InputViewportData = FScreenPassTextureViewport{ inputs.Textures[0].Texture };
+    inputs.OutputViewportData = FScreenPassTextureViewport{ sceneColor, view.ViewRect };
+
+    EGP::FScreenSpacePassComputeState state;
+    state.GroupCount.Set<TTuple<FRDGBufferRef, uint32>>(MakeTuple(indirectArgs, 0u));
+
+    return EGP::AddScreenSpaceComputePass<FGoLDisplayCS>(
+        graph, RDG_EVENT_NAME("GoL_DisplayTiled"), inputs,
+        state, params, material
+    );
+}
+
 #pragma endregion
 
 #pragma region Tick the sim state
 
-struct FGoLSimulateCS : public EGP::FSimulationShader
+//A fused Simulation shader, so the Material can add its own stages between the rules and part 2.
+struct FGoLSimulateCS : public EGP::FFusedSimulationShader
 {
     DECLARE_EXPORTED_SHADER_TYPE(FGoLSimulateCS, Material, );
     static FIntVector3 GroupSize() { return { 8, 8, 1 }; }
@@ -214,13 +587,13 @@ struct FGoLSimulateCS : public EGP::FSimulationShader
         SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float2>, NextSimStateTex)
         EGP_SIMULATION_PASS_MATERIAL_DATA()
     END_SHADER_PARAMETER_STRUCT()
-    SHADER_USE_PARAMETER_STRUCT_WITH_LEGACY_BASE(FGoLSimulateCS, EGP::FSimulationShader)
+    SHADER_USE_PARAMETER_STRUCT_WITH_LEGACY_BASE(FGoLSimulateCS, EGP::FFusedSimulationShader)
 
     //Feed the group size to the shader so that it's only defined in one place.
     static void ModifyCompilationEnvironment(const FMaterialShaderPermutationParameters& params,
                                              FShaderCompilerEnvironment& env)
     {
-        EGP::FSimulationShader::ModifyCompilationEnvironment(params, env);
+        EGP::FFusedSimulationShader::ModifyCompilationEnvironment(params, env);
         env.SetDefine(TEXT("SIM_GROUP_SIZE_X"), GroupSize().X);
         env.SetDefine(TEXT("SIM_GROUP_SIZE_Y"), GroupSize().Y);
         env.SetDefine(TEXT("SIM_GROUP_SIZE_Z"), GroupSize().Z);
@@ -229,7 +602,8 @@ struct FGoLSimulateCS : public EGP::FSimulationShader
 
 IMPLEMENT_MATERIAL_SHADER_TYPE(, FGoLSimulateCS, TEXT("/GameOfLife/Simulate.usf"), TEXT("Main"), SF_Compute);
 
-static void UpdateGoLState(FRDGBuilder& graph, const FViewInfo& view,
+//Returns false if the Material's shaders aren't ready yet.
+static bool UpdateGoLState(FRDGBuilder& graph, const FViewInfo& view,
                            FRDGTextureRef currentSimState, FRDGTextureRef nextSimState,
                            float deltaSeconds,
                            const UMaterialInterface* uMaterial)
@@ -255,15 +629,50 @@ static void UpdateGoLState(FRDGBuilder& graph, const FViewInfo& view,
         FGoLSimulateCS::GroupSize()
     ));
 
-    EGP::AddSimulationMaterialPass<FGoLSimulateCS>(graph, RDG_EVENT_NAME("GoL_Tick"),
-                                                    inputs, state, view,
-                                                    params, uMaterial);
+    return EGP::AddFusedSimulationMaterialPass<FGoLSimulateCS>(graph, RDG_EVENT_NAME("GoL_Tick"),
+                                                                inputs, state, view,
+                                                                params, uMaterial);
+}
+
+#pragma endregion
+
+#pragma region Precache the effect Material's pipelines
+
+//Precaches the pipeline states of every pass that uses the effect Material,
+//    so that assigning a new one doesn't hitch the first frame it's used.
+//Returns false if some of its own shaders aren't compiled yet, even if a fallback Material's are.
+static bool PrecacheGoLMaterialPSOs(ERHIFeatureLevel::Type featureLevel, const UMaterialInterface* uMaterial)
+{
+    const auto simStateDesc = FGameOfLifeView::SimStateDesc({ 2, 2 });
+    const auto& sceneTexturesConfig = FSceneTexturesConfig::Get();
+
+    //Don't short-circuit, so that whichever shaders are ready get precached right away.
+    const bool initDone = EGP::PrecacheMaterialRenderPSO<EGP::FScreenSpaceRenderVS, FGoLInitializePS>(
+                              uMaterial, featureLevel,
+                              EGP::FScreenSpacePassRenderState{ },
+                              simStateDesc.Format, simStateDesc.Flags
+                          ),
+               displayDone = EGP::PrecacheMaterialRenderPSO<EGP::FScreenSpaceRenderVS, FGoLDisplayPS>(
+                                 uMaterial, featureLevel,
+                                 EGP::FScreenSpacePassRenderState{ GetGoLDisplayBlendState() },
+                                 sceneTexturesConfig.ColorFormat, sceneTexturesConfig.ColorCreateFlags
+                             ),
+               displayTiledDone = EGP::PrecacheMaterialComputePSO<FGoLDisplayCS>(uMaterial, featureLevel),
+               simulateDone = EGP::PrecacheMaterialComputePSO<FGoLSimulateCS>(uMaterial, featureLevel);
+    return initDone && displayDone && displayTiledDone && simulateDone;
 }
 
 #pragma endregion
 
 #pragma region Primitive Component draw passes
 
+UGoLComponent::UGoLComponent()
+{
+    //There may be thousands of these, so let the pass update them in bulk.
+    //They then don't need a tick function at all.
+    UpdateFromSubsystem = true;
+    PrimaryComponentTick.bCanEverTick = false;
+}
 TSubclassOf<U_EGP_RenderPass> UGoLComponent::GetPassType() const
 {
     return U_GOL_RenderPass::StaticClass();
@@ -284,7 +693,7 @@ public:
 
     static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& params)
     {
-        return params.MaterialParameters.MaterialDomain == MD_Surface &&
+        return EGP::ShouldCompileCustomMeshPassPermutation(params) &&
                FMeshMaterialShader::ShouldCompilePermutation(params);
     }
 
@@ -301,7 +710,7 @@ public:
 
     static bool ShouldCompilePermutation(const FMeshMaterialShaderPermutationParameters& params)
     {
-        return params.MaterialParameters.MaterialDomain == MD_Surface &&
+        return EGP::ShouldCompileCustomMeshPassPermutation(params) &&
                FMeshMaterialShader::ShouldCompilePermutation(params);
     }
 
@@ -367,6 +776,17 @@ BEGIN_SHADER_PARAMETER_STRUCT(FGoLMeshPassParameters, )
     RENDER_TARGET_BINDING_SLOTS()
 END_SHADER_PARAMETER_STRUCT()
 
+static FRHIBlendState* GetGoLMeshBlendState(EGoLMeshBlendModes mode)
+{
+    switch (mode)
+    {
+        case EGoLMeshBlendModes::Alpha: return TStaticBlendState<CW_RGBA, BO_Add, BF_SourceAlpha, BF_InverseSourceAlpha>::GetRHI();
+        case EGoLMeshBlendModes::Additive: return TStaticBlendState<CW_RGBA, BO_Add, BF_One, BF_One>::GetRHI();
+        case EGoLMeshBlendModes::Multiply: return TStaticBlendState<CW_RGBA, BO_Add, BF_DestColor, BF_Zero>::GetRHI();
+        default: check(false); return nullptr;
+    }
+}
+
 //Generates actual draw calls for various kinds of 3D primitives.
 class FGoLMeshProcessor final : public FMeshPassProcessor
 {
@@ -393,15 +813,10 @@ public:
                       const FPrimitiveSceneProxy* proxy, int32 staticMeshID,
                       FRHITexture* prevState, FRHISamplerState* prevStateSampler)
     {
-        //Get the first usable Material in the chain,
-        //    starting at the batch's desired Material and ending at the Default Material.
-        const FMaterialRenderProxy* fallbackMat = nullptr;
-        const auto& resource = batch.MaterialRenderProxy->GetMaterialWithFallback(
-            FeatureLevel, fallbackMat
-        );
-        const auto& materialProxy = fallbackMat ? *fallbackMat : *batch.MaterialRenderProxy;
-        
-        //Compile our shaders against the batch's Material and Vertex-Factory.
+        //Get our shaders for the batch's Material and Vertex-Factory,
+        //    or the Default Material if they weren't compiled for it.
+        const FMaterialRenderProxy* materialProxyPtr;
+        const FMaterial* resourcePtr;
         TMeshProcessorShaders<FGoLMeshVS, FGoLMeshPS> shaderRefs;
         {
             FMaterialShaderTypes shaderTypes;
@@ -409,11 +824,15 @@ public:
             shaderTypes.AddShaderType<FGoLMeshPS>();
 
             FMaterialShaders materialShaders;
-            verify(resource.TryGetShaders(shaderTypes, batch.VertexFactory->GetType(), materialShaders));
+            if (!EGP::FindMeshPassShaders(batch, FeatureLevel, shaderTypes, true,
+                                          materialProxyPtr, resourcePtr, materialShaders))
+                return;
 
             materialShaders.TryGetVertexShader(shaderRefs.VertexShader);
             materialShaders.TryGetPixelShader(shaderRefs.PixelShader);
         }
+        const auto& materialProxy = *materialProxyPtr;
+        const auto& resource = *resourcePtr;
 
         //Configure per-element settings.
         FGoLMeshShaderElementData elementData;
@@ -438,10 +857,88 @@ public:
     //The usual 'AddMeshBatch()' will not be used; instead we will use an alternative with more parameters.
     virtual void AddMeshBatch(const FMeshBatch& batch, uint64 batchElementMask,
                               const FPrimitiveSceneProxy* proxy, int32 staticMeshID) override { check(false); }
+
+#if ENGINE_MINOR_VERSION > 3
+    //Reports every pipeline state this pass could use for the given Material and Vertex Factory,
+    //    so the engine can precache them when a component loads.
+    virtual void CollectPSOInitializers(const FSceneTexturesConfig& sceneTexturesConfig,
+                                        const FMaterial& material,
+                                        const FPSOPrecacheVertexFactoryData& vertexFactoryData,
+                                        const FPSOPrecacheParams& precacheParams,
+                                        TArray<FPSOPrecacheData>& outPSOs) override
+    {
+        //Materials and vertex factories our shaders weren't compiled for are skipped below.
+        if (material.GetMaterialDomain() != MD_Surface)
+            return;
+
+        TMeshProcessorShaders<FGoLMeshVS, FGoLMeshPS> shaderRefs;
+        {
+            FMaterialShaderTypes shaderTypes;
+            shaderTypes.AddShaderType<FGoLMeshVS>();
+            shaderTypes.AddShaderType<FGoLMeshPS>();
+
+            FMaterialShaders materialShaders;
+            if (!material.TryGetShaders(shaderTypes, vertexFactoryData.VertexFactoryType, materialShaders))
+                return;
+
+            materialShaders.TryGetVertexShader(shaderRefs.VertexShader);
+            materialShaders.TryGetPixelShader(shaderRefs.PixelShader);
+        }
+
+        //The render target is the sim state, tested against the downsampled scene depth.
+        const auto simStateDesc = FGameOfLifeView::SimStateDesc({ 2, 2 });
+        FGraphicsPipelineRenderTargetsInfo renderTargets;
+        renderTargets.NumSamples = 1;
+        AddRenderTargetInfo(simStateDesc.Format, simStateDesc.Flags, renderTargets);
+        SetupDepthStencilInfo(PF_DepthStencil, sceneTexturesConfig.DepthCreateFlags,
+                              ERenderTargetLoadAction::ELoad, ERenderTargetLoadAction::ENoAction,
+                              FExclusiveDepthStencil::DepthRead_StencilNop, renderTargets);
+
+        const FMeshDrawingPolicyOverrideSettings overrides = ComputeMeshOverrideSettings(precacheParams);
+        const auto fillMode = ComputeMeshFillMode(material, overrides);
+        const auto cullMode = ComputeMeshCullMode(material, overrides);
+
+        //Components pick their blend mode, so any of them could be needed.
+        auto drawState = PassDrawState;
+        for (auto blendMode : TEnumRange<EGoLMeshBlendModes>())
+        {
+            drawState.SetBlendState(GetGoLMeshBlendState(blendMode));
+            AddGraphicsPipelineStateInitializer(
+                vertexFactoryData, material, drawState, renderTargets, shaderRefs,
+                fillMode, cullMode, static_cast<EPrimitiveType>(precacheParams.PrimitiveType),
+                EMeshPassFeatures::Default, true, outPSOs
+            );
+        }
+    }
+#endif
 };
 
+#if ENGINE_MINOR_VERSION > 3
+//Registers the mesh pass with the engine's PSO precaching.
+static IPSOCollector* CreateGoLPSOCollector(ERHIFeatureLevel::Type featureLevel)
+{
+    return new FGoLMeshProcessor(nullptr, nullptr, featureLevel, nullptr,
+                                 GetGoLMeshBlendState(EGoLMeshBlendModes::Alpha));
+}
+static FRegisterPSOCollectorCreateFunction RegisterGoLPSOCollector(
+    &CreateGoLPSOCollector, EShadingPath::Deferred, TEXT("GameOfLife")
+);
+#endif
+
 #pragma endregion
 
+U_GOL_RenderPass::U_GOL_RenderPass()
+    : PrimaryViewFilter(CreateDefaultSubobject<U_EGP_ViewFilter>(TEXT("PrimaryViewFilter")))
+{
+    
+}
+const FGoLViewPolicy& U_GOL_RenderPass::GetViewPolicy_RenderThread(const FSceneView& view) const
+{
+    check(IsInRenderingThread());
+    return (EGP::IsPrimaryView(view) && PrimaryViewFilter->ShouldRenderFor(view)) ?
+               primaryViewPolicy_RenderThread :
+               secondaryViewPolicy_RenderThread;
+}
 TSharedRef<F_EGP_RenderPassSceneViewExtension> U_GOL_RenderPass::InitThisPass_GameThread(UWorld& thisWorld)
 {
     return FSceneViewExtensions::NewExtension<F_GOL_PassSVE>(this);
@@ -460,23 +957,68 @@ void U_GOL_RenderPass::ReInitializeAllViews()
 void U_GOL_RenderPass::Tick_GameThread(UWorld& thisWorld, float deltaSeconds)
 {
     Super::Tick_GameThread(thisWorld, deltaSeconds);
+    PrimaryViewFilter->PublishChanges_GameThread();
 
     //Update render-thread copies of our parameters.
     auto* matIn = EffectMaterial;
     auto* matOut = &effectMaterial_RenderThread;
-    ENQUEUE_RENDER_COMMAND(UpdateGoLParams)([matIn, matOut](FRHICommandList& cmds)
+    auto divisorIn = SimResolutionDivisor;
+    auto* divisorOut = &simResolutionDivisor_RenderThread;
+    auto upsampleIn = EdgeAwareUpsample;
+    auto* upsampleOut = &edgeAwareUpsample_RenderThread;
+    auto lodBiasIn = MeshLODBias;
+    auto* lodBiasOut = &meshLODBias_RenderThread;
+    auto minCoverageIn = MinCellCoverage;
+    auto* minCoverageOut = &minCellCoverage_RenderThread;
+    auto maxStampsIn = MaxStampsPerFrame;
+    auto* maxStampsOut = &maxStampsPerFrame_RenderThread;
+    auto skipDeadTilesIn = SkipDeadDisplayTiles;
+    auto* skipDeadTilesOut = &skipDeadDisplayTiles_RenderThread;
+    auto memoryBudgetIn = static_cast<uint64>(FMath::Max(0, PerViewMemoryBudgetMB)) * 1024 * 1024;
+    auto* memoryBudgetOut = &PerViewData.MemoryBudgetBytes;
+    auto parkFramesIn = ParkIdleViewsAfterFrames;
+    auto* parkFramesOut = &PerViewData.ParkFrameThreshold;
+    auto primaryPolicyIn = PrimaryViewPolicy,
+         secondaryPolicyIn = SecondaryViewPolicy;
+    auto* primaryPolicyOut = &primaryViewPolicy_RenderThread;
+    auto* secondaryPolicyOut = &secondaryViewPolicy_RenderThread;
+    ENQUEUE_RENDER_COMMAND(UpdateGoLParams)([matIn, matOut,
+                                             divisorIn, divisorOut,
+                                             upsampleIn, upsampleOut,
+                                             lodBiasIn, lodBiasOut,
+                                             minCoverageIn, minCoverageOut,
+                                             maxStampsIn, maxStampsOut,
+                                             skipDeadTilesIn, skipDeadTilesOut,
+                                             memoryBudgetIn, memoryBudgetOut,
+                                             parkFramesIn, parkFramesOut,
+                                             primaryPolicyIn, primaryPolicyOut,
+                                             secondaryPolicyIn, secondaryPolicyOut](FRHICommandList& cmds)
     {
         *matOut = matIn;
+        *divisorOut = divisorIn;
+        *upsampleOut = upsampleIn;
+        *lodBiasOut = lodBiasIn;
+        *minCoverageOut = minCoverageIn;
+        *maxStampsOut = maxStampsIn;
+        *skipDeadTilesOut = skipDeadTilesIn;
+        *memoryBudgetOut = memoryBudgetIn;
+        *parkFramesOut = parkFramesIn;
+        *primaryPolicyOut = primaryPolicyIn;
+        *secondaryPolicyOut = secondaryPolicyIn;
     });
 }
 void U_GOL_RenderPass::Tick_RenderThread(const FSceneInterface& thisScene, float gameThreadDeltaSeconds)
 {
-    if (effectMaterial_RenderThread)
-        EnsureCompiledSimulateShader(thisScene.GetFeatureLevel(), effectMaterial_RenderThread);
-    
     Super::Tick_RenderThread(thisScene, gameThreadDeltaSeconds);
     PerViewData.Tick();
 
+    //When the effect Material changes, precache its pipelines (retrying while its shaders compile).
+    if (effectMaterial_RenderThread != precachedEffectMaterial_RenderThread &&
+        PrecacheGoLMaterialPSOs(thisScene.GetFeatureLevel(), effectMaterial_RenderThread))
+    {
+        precachedEffectMaterial_RenderThread = effectMaterial_RenderThread;
+    }
+
     //Update the delta-time for each viewport's next tick.
     PerViewData.ForEachView([&](int viewID, FGameOfLifeView& view, ERHIFeatureLevel::Type featureLevel) {
         view.NextTickTime += gameThreadDeltaSeconds;
@@ -497,39 +1039,60 @@ void F_GOL_PassSVE::PrePostProcessPass_RenderThread(FRDGBuilder& graph, const FS
                     view.ViewRect.Width(), view.ViewRect.Height());
     
     //Get or create the per-view data.
+    //Scalability settings may override the pass's own.
+    const int32 resolutionDivisorOverride = CVarGoLSimResolutionDivisor.GetValueOnRenderThread();
+    const int32 resolutionDivisor = FMath::Max(1, resolutionDivisorOverride > 0 ?
+                                                      resolutionDivisorOverride :
+                                                      Pass->GetSimResolutionDivisor_RenderThread());
     auto& viewData = Pass->PerViewData.DataForView(
         graph, view,
         //For new views, the view data constructor arguments:
-        passMaterial, GetSceneTextureShaderParameters(inputs.SceneTextures)
+        passMaterial, GetSceneTextureShaderParameters(inputs.SceneTextures), resolutionDivisor
     );
+    viewData.SetResolutionDivisor(graph, view, resolutionDivisor);
     auto simStateRDG = RegisterExternalTexture(graph, viewData.SimState, TEXT("GoL_State"));
 
     //If re-initialization was requested, do that first.
     if (viewData.ReinitializeViews)
     {
         RDG_EVENT_SCOPE(graph, "GoL: Re-initialize");
-        InitGoLState(graph, simStateRDG, view,
-                     GetSceneTextureShaderParameters(inputs.SceneTextures),
-                     passMaterial);
-        viewData.ReinitializeViews = false;
+        //If the Material's shaders are still compiling, try again next frame.
+        viewData.ReinitializeViews = !InitGoLState(graph, simStateRDG, view,
+                                                   GetSceneTextureShaderParameters(inputs.SceneTextures),
+                                                   passMaterial);
     }
+
+    //Secondary views may update their sim less often.
+    const auto& policy = Pass->GetViewPolicy_RenderThread(view);
+    const uint32 policyFrame = viewData.PolicyFrame++;
+    const bool tickThisFrame = !policy.DisplayOnly &&
+                               (policyFrame % static_cast<uint32>(FMath::Max(1, policy.TickDivisor) *
+                                                                  FMath::Max(1, CVarGoLTickDivisor.GetValueOnRenderThread()))) == 0,
+               drawMeshesThisFrame = !policy.DisplayOnly &&
+                                     (policyFrame % static_cast<uint32>(FMath::Max(1, policy.MeshPassDivisor))) == 0;
+    //A display-only view shouldn't jump forward by all its idle time once it's allowed to tick again.
+    if (policy.DisplayOnly)
+        viewData.NextTickTime = 0;
+
     //If some time has passed on the game thread, tick this viewport's sim.
-    if (viewData.NextTickTime > 0)
+    if (tickThisFrame && viewData.NextTickTime > 0)
     {
         RDG_EVENT_SCOPE(graph, "GoL: Tick %f seconds", viewData.NextTickTime);
         
         auto nextSimStateRDG = RegisterExternalTexture(graph, viewData.SimBuffer, TEXT("GoL_NextState"));
-        UpdateGoLState(
-            graph, view,
-            simStateRDG, nextSimStateRDG,
-            viewData.NextTickTime, passMaterial
-        );
-        std::swap(viewData.SimBuffer, viewData.SimState);
-        simStateRDG = nextSimStateRDG;
-        viewData.NextTickTime = 0;
+        //If the Material's shaders are still compiling, keep the time for the next tick.
+        if (UpdateGoLState(graph, view,
+                           simStateRDG, nextSimStateRDG,
+                           viewData.NextTickTime, passMaterial))
+        {
+            std::swap(viewData.SimBuffer, viewData.SimState);
+            simStateRDG = nextSimStateRDG;
+            viewData.NextTickTime = 0;
+        }
     }
 
     //Draw our mesh pass into the sim state.
+    if (drawMeshesThisFrame)
     {
         RDG_EVENT_SCOPE(graph, "GoL: Mesh passes (%i primitives)",
                         Pass->GetComponentData_RenderThread().Num());
@@ -543,23 +1106,15 @@ void F_GOL_PassSVE::PrePostProcessPass_RenderThread(FRDGBuilder& graph, const FS
         //    rather than being a subset of a larger render target,
         //    and also uses a lower-resolution than the viewport.
         //To fix this, we need to resample the depth buffer.
-        FRDGTextureRef depthBuffer = inputs.SceneTextures->GetContents()->SceneDepthTexture;
-        if (view.ViewRect.Min != FIntPoint::ZeroValue || depthBuffer->Desc.Extent != viewData.SimState->GetSizeXY())
-        {
-            auto resampledDepthBufferDesc = depthBuffer->Desc;
-            resampledDepthBufferDesc.Extent = viewData.SimState->GetSizeXY();
-            FRDGTextureRef resampledDepthBuffer = graph.CreateTexture(
-                resampledDepthBufferDesc, TEXT("GoL_ResampledSceneDepth")
-            );
-            
-            EGP::AddDownsampleDepthPass(
-                graph, view,
-                FScreenPassTexture{ depthBuffer, view.ViewRect },
-                FScreenPassRenderTarget{ resampledDepthBuffer, ERenderTargetLoadAction::ENoAction },
-                EDownsampleDepthFilter::Checkerboard
-            );
-            depthBuffer = resampledDepthBuffer;
-        }
+        //The reduction comes out of the view's depth pyramid, which other EGP passes this frame will share,
+        //    and lands in a real depth target so the hardware depth test (and its early-Z) still works.
+        const auto simResolution = FIntPoint{ viewData.SimState->GetSizeXY() };
+        FRDGTextureRef depthBuffer = EGP::GetDownsampledDepth(
+            graph, view,
+            inputs.SceneTextures->GetContents()->SceneDepthTexture,
+            simResolution,
+            EDownsampleDepthFilter::Checkerboard
+        );
 
         //Note that it doesn't matter if the texture has already been registered in this graph previously --
         //    in that case its previous RDG handle will be returned here.
@@ -581,8 +1136,9 @@ void F_GOL_PassSVE::PrePostProcessPass_RenderThread(FRDGBuilder& graph, const FS
         };
 
         //Dispatch the draw calls.
+        //Instanced primitives (foliage, ISM's, Niagara meshes) get their instances culled and compacted by GPU-Scene.
         AddCopyTexturePass(graph, simStateRDG, nextSimStateRDG);
-        AddSimpleMeshPass(graph, passParams, renderScene, view, nullptr,
+        AddSimpleMeshPass(graph, passParams, renderScene, view, EGP::GetInstanceCullingManager(view),
                           RDG_EVENT_NAME("GoLMeshes"),
                           FIntRect{ FIntPoint::ZeroValue, simStateRDG->Desc.Extent },
                           [&](FDynamicPassMeshDrawListContext* output)
@@ -590,23 +1146,89 @@ void F_GOL_PassSVE::PrePostProcessPass_RenderThread(FRDGBuilder& graph, const FS
             //Define one mesh processor for each blend mode.
             FGoLMeshProcessor meshProcessorAlpha{
                 renderScene, &view, view.FeatureLevel, output,
-                TStaticBlendState<CW_RGBA, BO_Add, BF_SourceAlpha, BF_InverseSourceAlpha>::GetRHI()
+                GetGoLMeshBlendState(EGoLMeshBlendModes::Alpha)
             };
             FGoLMeshProcessor meshProcessorAdditive{
                 renderScene, &view, view.FeatureLevel, output,
-                TStaticBlendState<CW_RGBA, BO_Add, BF_One, BF_One>::GetRHI()
+                GetGoLMeshBlendState(EGoLMeshBlendModes::Additive)
             };
             FGoLMeshProcessor meshProcessorMultiply{
                 renderScene, &view, view.FeatureLevel, output,
-                TStaticBlendState<CW_RGBA, BO_Add, BF_DestColor, BF_Zero>::GetRHI()
+                GetGoLMeshBlendState(EGoLMeshBlendModes::Multiply)
             };
 
-            //Get every scene primitive that's tagged with our custom component.
-            ForEachComponent_RenderThread([&](const UGoLComponent& component,
-                                                     const FGoLPrimitiveRenderSettings& componentSettings,
-                                                     const UPrimitiveComponent& primitive,
+            //Primitives covering less than a sim cell are culled.
+            //Measure their projected size against the sim resolution rather than the viewport's.
+            //The size is the bounding sphere's projected diameter as a fraction of the screen,
+            //    computed here rather than with 'ComputeBoundsScreenSize()' so the radius/diameter question is explicit.
+            const auto GetProjectedDiameter = [](const FBoxSphereBounds& bounds, const FViewInfo& view)
+            {
+                const auto& projection = view.ViewMatrices.GetProjectionMatrix();
+                //Clip-space spans [-1, 1], so half the projection scale maps world size to a fraction of the screen.
+                const float screenMultiple = 0.5f * static_cast<float>(FMath::Max(projection.M[0][0], projection.M[1][1]));
+                const float diameter = 2.0f * static_cast<float>(bounds.SphereRadius);
+                if (!view.IsPerspectiveProjection())
+                    return diameter * screenMultiple;
+                const float distance = static_cast<float>(FVector::Dist(bounds.Origin, view.ViewMatrices.GetViewOrigin()));
+                return diameter * screenMultiple / FMath::Max(1.0f, distance);
+            };
+            const float minCellCoverage = Pass->GetMinCellCoverage_RenderThread();
+            const float simCellsAcrossScreen = static_cast<float>(simResolution.GetMax());
+
+            //Get every scene primitive in view that's tagged with our custom component,
+            //    and is due to be drawn this frame.
+            if (renderScene == nullptr)
+                return;
+            struct FStampCandidate
+            {
+                uint32 ID;
+                const FGoLPrimitiveRenderSettings* Settings;
+                const FPrimitiveSceneProxy* PrimitiveProxy;
+            };
+            TArray<FStampCandidate, SceneRenderingAllocator> candidates;
+            const uint32 stampFrame = viewData.StampFrame++;
+            ForEachVisibleComponent_RenderThread(*renderScene, view,
+                                                 [&](const FGoLPrimitiveRenderSettings& componentSettings,
                                                      const FPrimitiveSceneProxy& primitiveProxy)
             {
+                if (minCellCoverage > 0)
+                {
+                    const auto& bounds = primitiveProxy.GetBounds();
+                    if (GetProjectedDiameter(bounds, view) * simCellsAcrossScreen < minCellCoverage)
+                        return;
+                }
+
+                //Components with a refresh interval are staggered by their ID,
+                //    so they don't all land on the same frame.
+                const uint32 id = primitiveProxy.GetPrimitiveComponentId().PrimValue;
+                const uint32 refreshInterval = static_cast<uint32>(FMath::Max(1, componentSettings.RefreshInterval));
+                if ((stampFrame + id) % refreshInterval != 0)
+                    return;
+
+                candidates.Add({ id, &componentSettings, &primitiveProxy });
+            });
+
+            //If more components are due than the budget allows, draw the next batch after last frame's,
+            //    in order of primitive ID, and wrap around.
+            int32 firstCandidate = 0,
+                  nCandidatesToDraw = candidates.Num();
+            const int32 maxStamps = Pass->GetMaxStampsPerFrame_RenderThread();
+            if (maxStamps > 0 && candidates.Num() > maxStamps)
+            {
+                candidates.Sort([](const FStampCandidate& a, const FStampCandidate& b) { return a.ID < b.ID; });
+                firstCandidate = Algo::LowerBoundBy(candidates, viewData.StampCursor, &FStampCandidate::ID);
+                nCandidatesToDraw = maxStamps;
+
+                const auto& lastDrawn = candidates[(firstCandidate + maxStamps - 1) % candidates.Num()];
+                viewData.StampCursor = lastDrawn.ID + 1;
+            }
+
+            for (int32 i = 0; i < nCandidatesToDraw; ++i)
+            {
+                const auto& candidate = candidates[(firstCandidate + i) % candidates.Num()];
+                const auto& componentSettings = *candidate.Settings;
+                const auto& primitiveProxy = *candidate.PrimitiveProxy;
+
                 //Pick the blend mode.
                 FGoLMeshProcessor* componentProcessor;
                 switch (componentSettings.BlendMode)
@@ -614,18 +1236,23 @@ void F_GOL_PassSVE::PrePostProcessPass_RenderThread(FRDGBuilder& graph, const FS
                     case EGoLMeshBlendModes::Alpha: componentProcessor = &meshProcessorAlpha; break;
                     case EGoLMeshBlendModes::Additive: componentProcessor = &meshProcessorAdditive; break;
                     case EGoLMeshBlendModes::Multiply: componentProcessor = &meshProcessorMultiply; break;
-                    default: check(false); return;
+                    default: check(false); continue;
                 }
                 
-                //Draw every renderable mesh-batch in that component.
-                EGP::ForEachBatch(view, &primitiveProxy,
+                //Draw every renderable mesh-batch in that component,
+                //    picking coarser LODs to match the sim's lower resolution.
+                const auto lodSettings = EGP::FMeshPassLODSettings::ForResolution(
+                    view, simResolution,
+                    Pass->GetMeshLODBias_RenderThread() + componentSettings.LODBias
+                );
+                EGP::ForEachBatch(view, &primitiveProxy, lodSettings,
                                    [&](const FMeshBatch& batch, uint64 mask, const auto* sceneProxy, int staticMeshID)
                 {
                     componentProcessor->AddMeshBatch(batch, mask, sceneProxy, staticMeshID,
                                                      viewData.SimState,
                                                      TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp>::GetRHI());
                 });
-            });
+            }
         });
 
         //Swap 'previous' and 'next' textures.
@@ -633,16 +1260,33 @@ void F_GOL_PassSVE::PrePostProcessPass_RenderThread(FRDGBuilder& graph, const FS
         simStateRDG = nextSimStateRDG;
     }
     
+    //Optionally upsample the sim to full resolution, so it doesn't bleed across depth edges.
+    auto displayedStateRDG = simStateRDG;
+    const int32 upsampleOverride = CVarGoLEdgeAwareUpsample.GetValueOnRenderThread();
+    if (upsampleOverride < 0 ? Pass->GetEdgeAwareUpsample_RenderThread() : (upsampleOverride > 0))
+    {
+        displayedStateRDG = UpsampleGoLState(graph, view, simStateRDG,
+                                             inputs.SceneTextures->GetContents()->SceneDepthTexture);
+    }
+
     //Finally, draw the sim state onto the scene color texture.
-    RenderGoLState(
-        graph, view, simStateRDG,
-        //Use multiplicative blending.
-        TStaticBlendState<CW_RGBA, BO_Add, BF_DestColor, BF_Zero>::GetRHI(),
-        //Blend on top of the current scene color, so make sure its existing contents are Loaded when bound.
-        { inputs.SceneTextures->GetContents()->SceneColorTexture, ERenderTargetLoadAction::ELoad },
-        passMaterial,
-        GetSceneTextureShaderParameters(inputs.SceneTextures)
-    );
+    //If allowed, skip the parts of the screen where everything is dead.
+    auto sceneColor = inputs.SceneTextures->GetContents()->SceneColorTexture;
+    const bool displayedTiles = Pass->GetSkipDeadDisplayTiles_RenderThread() &&
+                                CanDisplayGoLTiles(sceneColor) &&
+                                RenderGoLStateTiled(graph, view, simStateRDG, displayedStateRDG, sceneColor, passMaterial,
+                                                    GetSceneTextureShaderParameters(inputs.SceneTextures));
+    if (!displayedTiles)
+    {
+        RenderGoLState(
+            graph, view, displayedStateRDG,
+            GetGoLDisplayBlendState(),
+            //Blend on top of the current scene color, so make sure its existing contents are Loaded when bound.
+            { sceneColor, ERenderTargetLoadAction::ELoad },
+            passMaterial,
+            GetSceneTextureShaderParameters(inputs.SceneTextures)
+        );
+    }
 }
 
 #if WITH_EDITOR
@@ -748,3 +1392,19 @@ void UGoLUtilities::GetLandscapeComponents(ALandscape* landscape, TArray<ULandsc
     for (TObjectIterator<ULandscapeComponent> it; it; ++it)
         output.Add(*it);
 }
+FGoLScalabilitySettings UGoLUtilities::GetGoLScalabilitySettings()
+{
+    FGoLScalabilitySettings settings;
+    settings.SimResolutionDivisor = CVarGoLSimResolutionDivisor.GetValueOnGameThread();
+    settings.TickDivisor = CVarGoLTickDivisor.GetValueOnGameThread();
+    settings.EdgeAwareUpsample = CVarGoLEdgeAwareUpsample.GetValueOnGameThread();
+    settings.UpsampleDepthSharpness = CVarGoLUpsampleDepthSharpness.GetValueOnGameThread();
+    return settings;
+}
+void UGoLUtilities::SetGoLScalabilitySettings(const FGoLScalabilitySettings& settings)
+{
+    CVarGoLSimResolutionDivisor->Set(FMath::Clamp(settings.SimResolutionDivisor, 0, 8), ECVF_SetByGameSetting);
+    CVarGoLTickDivisor->Set(FMath::Max(1, settings.TickDivisor), ECVF_SetByGameSetting);
+    CVarGoLEdgeAwareUpsample->Set(FMath::Clamp(settings.EdgeAwareUpsample, -1, 1), ECVF_SetByGameSetting);
+    CVarGoLUpsampleDepthSharpness->Set(FMath::Max(0.0f, settings.UpsampleDepthSharpness), ECVF_SetByGameSetting);
+}
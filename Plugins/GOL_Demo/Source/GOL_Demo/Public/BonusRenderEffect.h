@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "Materials/MaterialExpressionCustomOutput.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
 
 #include "EGP_CustomRenderPasses.h"
 
@@ -20,6 +21,38 @@ public:
 	//No settings for now.
 };
 
+//Quality settings that apply to every BRE primitive.
+//Each one is a console variable, so 'sg.EGPQuality' and device profiles can set them too.
+USTRUCT(BlueprintType)
+struct GOL_DEMO_API FBreScalabilitySettings
+{
+	GENERATED_BODY()
+public:
+
+	//'r.BRE.MaxLoopsScale': scales each Material's 'MaxLoops'.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	float MaxLoopsScale = 1.0f;
+	//'r.BRE.StepLengthScale': scales how far each loop iteration moves.
+	//The Material still sees its own unscaled 'StepLength'.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	float StepLengthScale = 1.0f;
+};
+
+UCLASS()
+class GOL_DEMO_API UBreUtilities : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+public:
+
+	//Gets the current values of the BRE's scalability cvars.
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	static FBreScalabilitySettings GetBreScalabilitySettings();
+	//Sets the BRE's scalability cvars.
+	//They then keep these values when 'sg.EGPQuality' changes.
+	UFUNCTION(BlueprintCallable)
+	static void SetBreScalabilitySettings(const FBreScalabilitySettings& settings);
+};
+
 UCLASS(meta=(BlueprintSpawnableComponent))
 class GOL_DEMO_API UBreComponent : public U_EGP_RenderPassComponent
 {
@@ -29,8 +62,11 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ShowOnlyInnerProperties))
 	FBrePrimitiveSettings RenderSettings;
 
+	UBreComponent();
+
 	virtual TSubclassOf<U_EGP_RenderPass> GetPassType() const override;
 	EGP_PASS_COMPONENT_SIMPLE_PROXY_IMPL(FBrePrimitiveSettings, RenderSettings)
+	virtual bool IsProxyConstructionThreadSafe() const override { return true; }
 };
 
 
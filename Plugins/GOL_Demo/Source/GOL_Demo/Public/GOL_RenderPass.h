@@ -2,6 +2,8 @@
 
 #include "CoreMinimal.h"
 #include "Materials/MaterialExpressionCustomOutput.h"
+#include "RHIGPUReadback.h"
+#include "Tasks/Task.h"
 
 #include "EGP_CustomRenderPasses.h"
 
@@ -31,18 +33,30 @@ public:
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	EGoLMeshBlendModes BlendMode = EGoLMeshBlendModes::Alpha;
+
+	//Static-mesh LOD levels to drop, on top of the pass's own bias.
+	//The sim's lower resolution is already accounted for.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	int LODBias = 0;
+
+	//The component is only drawn into the sim once every this many frames.
+	//Slow-moving or static components look the same at a higher interval, and cost less.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=1))
+	int RefreshInterval = 1;
 	
 	bool operator==(const FGoLPrimitiveRenderSettings& r2) const
 	{
-		return BlendMode == r2.BlendMode;
+		return BlendMode == r2.BlendMode && LODBias == r2.LODBias && RefreshInterval == r2.RefreshInterval;
 	}
 };
 inline uint32 GetTypeHash(const FGoLPrimitiveRenderSettings& r)
 {
-	return GetTypeHash(MakeTuple(r.BlendMode));
+	return GetTypeHash(MakeTuple(r.BlendMode, r.LODBias, r.RefreshInterval));
 }
 
 //Marks a primitive-component (mesh, particle system, etc) so that it renders into the GoL sim.
+//The GoL shaders are only compiled for opaque and masked Materials on common mesh types;
+//    other Materials are drawn into the sim with the Default Material.
 UCLASS(meta=(BlueprintSpawnableComponent))
 class GOL_DEMO_API UGoLComponent : public U_EGP_RenderPassComponent
 {
@@ -51,32 +65,118 @@ public:
 
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ShowOnlyInnerProperties))
 	FGoLPrimitiveRenderSettings RenderSettings;
+
+	UGoLComponent();
 	
 	virtual TSubclassOf<U_EGP_RenderPass> GetPassType() const override;
 	EGP_PASS_COMPONENT_SIMPLE_PROXY_IMPL(FGoLPrimitiveRenderSettings, RenderSettings)
+	virtual bool IsProxyConstructionThreadSafe() const override { return true; }
 };
 
 #pragma endregion
 
 #pragma region Render Pass objects
 
+//Quality settings that apply to every Game of Life pass and view.
+//Each one is a console variable, so 'sg.EGPQuality' and device profiles can set them too.
+USTRUCT(BlueprintType)
+struct GOL_DEMO_API FGoLScalabilitySettings
+{
+	GENERATED_BODY()
+public:
+
+	//'r.GoL.SimResolutionDivisor': if above 0, overrides every pass's 'SimResolutionDivisor'.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0, ClampMax=8))
+	int SimResolutionDivisor = 0;
+
+	//'r.GoL.TickDivisor': sims only tick once every this many frames,
+	//    on top of their view policy's own 'TickDivisor'.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=1))
+	int TickDivisor = 1;
+
+	//'r.GoL.EdgeAwareUpsample': -1 uses every pass's own 'EdgeAwareUpsample', 0 forces it off, 1 forces it on.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=-1, ClampMax=1))
+	int EdgeAwareUpsample = -1;
+
+	//'r.GoL.EdgeAwareUpsample.DepthSharpness': how strongly the upsample avoids blending across depth differences.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	float UpsampleDepthSharpness = 20.0f;
+};
+
+//How often a view updates its Game of Life sim.
+USTRUCT(BlueprintType)
+struct GOL_DEMO_API FGoLViewPolicy
+{
+	GENERATED_BODY()
+public:
+
+	//The sim only ticks on every Nth frame the view is rendered.
+	//Time still accumulates in between, so the sim runs at the same speed in bigger steps.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=1))
+	int TickDivisor = 1;
+
+	//Components are only drawn into the sim on every Nth frame the view is rendered.
+	//For example, 2 skips the mesh pass on alternate frames.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=1))
+	int MeshPassDivisor = 1;
+
+	//If true, the view neither ticks its sim nor draws components into it;
+	//    it only displays the sim's last state.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool DisplayOnly = false;
+};
+
 //An instance of the Game of Life sim, running in one particular viewport.
 struct GOL_DEMO_API FGameOfLifeView final : public F_EGP_ViewPersistentData
 {
-	static FRHITextureCreateDesc SimStateDesc(const FInt32Point& viewportSize);
+	static FRHITextureCreateDesc SimStateDesc(const FInt32Point& viewportSize, int32 resolutionDivisor = 2);
 	TRefCountPtr<FRHITexture> SimState, SimBuffer;
+	//The sim runs at the viewport's resolution divided by this.
+	int32 ResolutionDivisor = 2;
  
 	float NextTickTime = 0;
 	bool ReinitializeViews = false;
+
+	//Counts the frames this view was rendered, for its view policy.
+	uint32 PolicyFrame = 0;
+	//Counts this view's mesh passes, for components' refresh intervals.
+	uint32 StampFrame = 0;
+	//When the pass's draw budget is exceeded, components take turns in order of their primitive ID.
+	//This is the ID the next frame starts from.
+	uint32 StampCursor = 0;
 	
 	FGameOfLifeView(FRDGBuilder& graph, const FViewInfo& view, const FIntRect& viewportSubset,
 					const UMaterialInterface* initShaderMaterial,
-					const FSceneTextureShaderParameters& sceneTextures);
+					const FSceneTextureShaderParameters& sceneTextures,
+					int32 resolutionDivisor);
 	//Moves and destructor are handled automatically thanks to the ref-counted pointer.
 
+	//Resamples the sim to a new resolution divisor.
+	void SetResolutionDivisor(FRDGBuilder& graph, const FViewInfo& view, int32 newDivisor);
+
 	virtual void Resample(FRDGBuilder& graph, const FViewInfo& view,
 						  const FInt32Point& oldResolution, const FInt32Point& newResolution,
 						  const FInt32Point& offsetDelta) override;
+	virtual uint64 GetGPUMemoryBytes() const override;
+
+	//Idle views are parked with one bit per cell, compressed.
+	//The smooth value isn't kept; it restarts from the discrete one when unparked.
+	virtual bool BeginParking(FRDGBuilder& graph) override;
+	virtual bool TryFinishParking() override;
+	virtual void CancelParking() override;
+	virtual void Unpark(FRDGBuilder& graph, const FViewInfo& view) override;
+	virtual uint64 GetParkedBytes() const override;
+
+private:
+
+	void ResampleSimState(FRDGBuilder& graph, const FViewInfo& view, const FInt32Point& newViewportSize);
+
+	TUniquePtr<FRHIGPUTextureReadback> parkingReadback;
+	FIntPoint parkedSize{ 0, 0 };
+	int32 parkedPackedBytes = 0;
+	//Compression runs in the background; the GPU memory is released once it's done.
+	UE::Tasks::TTask<TArray<uint8>> parkedState;
+	TArray<uint8> parkedCompressed;
 };
 
 UCLASS(BlueprintType)
@@ -89,8 +189,77 @@ public:
 	UMaterialInterface* EffectMaterial = nullptr;
 	UMaterialInterface* GetEffectMaterial_RenderThread() const { check(IsInRenderingThread()); return effectMaterial_RenderThread; }
 
+	//The sim runs at the viewport's resolution divided by this.
+	//Higher values are much cheaper to simulate, draw into, and park;
+	//    turn on 'EdgeAwareUpsample' to keep the display sharp along depth edges.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=1, ClampMax=8))
+	int SimResolutionDivisor = 2;
+	int GetSimResolutionDivisor_RenderThread() const { check(IsInRenderingThread()); return simResolutionDivisor_RenderThread; }
+
+	//Upsamples the sim to the viewport's resolution before displaying it,
+	//    using the scene depth to keep cells from bleeding across depth edges.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool EdgeAwareUpsample = false;
+	bool GetEdgeAwareUpsample_RenderThread() const { check(IsInRenderingThread()); return edgeAwareUpsample_RenderThread; }
+
+	//Static-mesh LOD levels to drop for every component drawn into the sim.
+	//The sim's lower resolution is already accounted for.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	int MeshLODBias = 0;
+	int GetMeshLODBias_RenderThread() const { check(IsInRenderingThread()); return meshLODBias_RenderThread; }
+
+	//Components whose bounds cover fewer sim cells than this (measured across their diameter)
+	//    are too small to affect the sim, so they are skipped.
+	//Set to 0 to draw everything.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	float MinCellCoverage = 1.0f;
+	float GetMinCellCoverage_RenderThread() const { check(IsInRenderingThread()); return minCellCoverage_RenderThread; }
+
+	//The most components drawn into each view's sim per frame.
+	//If more are due, they take turns over the following frames.
+	//Set to 0 for no limit.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	int MaxStampsPerFrame = 0;
+	int GetMaxStampsPerFrame_RenderThread() const { check(IsInRenderingThread()); return maxStampsPerFrame_RenderThread; }
+
+	//Displays the sim with a compute pass that skips screen tiles where every cell is dead,
+	//    instead of blending it over the whole screen.
+	//Only enable this if the Effect Material's display output is exactly 1 wherever the cells it samples are dead,
+	//    and it samples the sim at the screen UV.
+	//Falls back to the full-screen pass where scene color can't be written as a UAV.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool SkipDeadDisplayTiles = false;
+	bool GetSkipDeadDisplayTiles_RenderThread() const { check(IsInRenderingThread()); return skipDeadDisplayTiles_RenderThread; }
+
+	//Views that aren't rendered for this many frames move their sim into system memory,
+	//    releasing its GPU memory until they're rendered again.
+	//Set to 0 to keep idle views' sims on the GPU until they're cleaned up.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	int ParkIdleViewsAfterFrames = 30;
+
+	//The most GPU memory the sims of every view may use together, in megabytes.
+	//When over budget, scene captures and stale views lose their sim first.
+	//Set to 0 to use the cvar 'r.EGP.PerViewData.BudgetMB'.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0))
+	int PerViewMemoryBudgetMB = 0;
+
+	//The update rate of players' views of the game.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="View Policies")
+	FGoLViewPolicy PrimaryViewPolicy;
+	//The update rate of every other view: scene captures, reflections, editor viewports,
+	//    and player views that don't pass 'PrimaryViewFilter'.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="View Policies")
+	FGoLViewPolicy SecondaryViewPolicy;
+	//Player views must also pass this filter to use the primary policy.
+	//By default it lets everything through.
+	UPROPERTY(BlueprintReadOnly, VisibleInstanceOnly, Transient, Category="View Policies")
+	U_EGP_ViewFilter* const PrimaryViewFilter = nullptr;
+	const FGoLViewPolicy& GetViewPolicy_RenderThread(const FSceneView& view) const;
+
 	T_EGP_PerViewData<FGameOfLifeView> PerViewData;
 
+	U_GOL_RenderPass();
+
 	UFUNCTION(BlueprintCallable)
 	void ReInitializeAllViews();
 
@@ -104,6 +273,15 @@ private:
 
 	// ReSharper disable once CppUE4ProbableMemoryIssuesWithUObject
 	UMaterialInterface* effectMaterial_RenderThread = nullptr;
+	//The effect Material whose pipeline states have been precached.
+	const UMaterialInterface* precachedEffectMaterial_RenderThread = nullptr;
+	int simResolutionDivisor_RenderThread = 2;
+	bool edgeAwareUpsample_RenderThread = false;
+	int meshLODBias_RenderThread = 0;
+	float minCellCoverage_RenderThread = 1.0f;
+	int maxStampsPerFrame_RenderThread = 0;
+	bool skipDeadDisplayTiles_RenderThread = false;
+	FGoLViewPolicy primaryViewPolicy_RenderThread, secondaryViewPolicy_RenderThread;
 };
 
 struct GOL_DEMO_API F_GOL_PassSVE : public T_EGP_RenderPassSceneViewExtension<
@@ -186,6 +364,9 @@ class GOL_DEMO_API UMaterialExpressionGoLSimulate2Outputs : public UMaterialExpr
 public:
 
 	//If not provided, the continuous state is set to match the discrete one.
+	//
+	//Any "EGP Fused Simulation: Stage" outputs in the Material run just before this one, in the same dispatch,
+	//    and their results can be read here with 'EGP_FUSED_STAGE_VALUE()' (see 'EGP_FusedSimulation.h').
 	UPROPERTY(meta=(RequiredInput=false))
 	FExpressionInput ContinuousValue;
 	
@@ -241,4 +422,12 @@ public:
 
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	static void GetLandscapeComponents(class ALandscape* landscape, TArray<class ULandscapeComponent*>& output);
+
+	//Gets the current values of the Game of Life's scalability cvars.
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	static FGoLScalabilitySettings GetGoLScalabilitySettings();
+	//Sets the Game of Life's scalability cvars.
+	//They then keep these values when 'sg.EGPQuality' changes.
+	UFUNCTION(BlueprintCallable)
+	static void SetGoLScalabilitySettings(const FGoLScalabilitySettings& settings);
 };
\ No newline at end of file